@@ -0,0 +1,46 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+
+#include <glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <settings.hpp>
+
+#define CAMERA_FOV 60.0f
+#define CAMERA_HEIGHT 1.5f
+#define CAMERA_NEAR 0.1f
+#define CAMERA_FAR 100.0f
+
+// Orbit camera around the cube. The view and projection matrices are cached
+// and only rebuilt when the view angles, the zoom or the framebuffer size
+// actually change. The flip of the view is folded into the view matrix so the
+// renderer no longer has to apply it to every piece.
+class Camera
+{
+public:
+
+	Camera(int width, int height);
+
+	void update(const SETTINGS& settings);
+	void set_viewport(int width, int height);
+
+	const glm::mat4& get_view() const;
+	const glm::mat4& get_projection() const;
+	int get_viewport_height() const;
+
+private:
+
+	float rotationAngle;
+	float flipAngle;
+	float zoom;
+	float aspect;
+	int viewportHeight;
+
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	void build_view();
+	void build_projection();
+};
+
+#endif
@@ -1,18 +1,26 @@
 #ifndef CUBE_HPP
 #define CUBE_HPP
 
-#include <piece.hpp>
+#include <piece_transforms.hpp>
+#include <timestep.hpp>
 #include <vector>
-#include <settings.hpp>
 #include <random>
+#include <cstdint>
+#include <memory_resource>
 
 #define DEFAULT_SIZE 3
-#define ROTATION_DURATION 0.2f
-#define SCRAMBLE_ROTATION_DURATION 0.2f
-
-#define VSHADER_PATH "resources/shaders/basicCube.vert"
-#define FSHADER_PATH "resources/shaders/basicCube.frag"
-#define TEXT_PATH "resources/textures/cubeTexture.png"
+#define MIN_CUBE_SIZE 2
+#define MAX_CUBE_SIZE 100
+#define DEFAULT_TURN_DURATION 0.2f
+#define MIN_TURN_DURATION 0.02f
+#define MAX_TURN_DURATION 1.0f
+#define SOLVE_PLAYBACK_TIME 10.0f
+#define BACKLOG_SPEEDUP 0.5f
+#define MAX_BACKLOG_SPEEDUP 6.0f
+#define MAX_PARALLEL_SLICES 16
+#define CUBE_QUEUE_RESERVE 64
+#define CUBE_HISTORY_LIMIT 2048
+#define TURN_LOG_SIZE 64
 
 enum RotateDirection { line, col, face};
 
@@ -22,42 +30,157 @@ struct RotationParams {
 	RotateDirection dir;
 };
 
-class Cube
+struct QueuedMove {
+	RotationParams params;
+	bool fromInput;
+	unsigned int inputId;
+	float duration;
+};
+
+// FIFO of pending moves over one vector. Popping only advances the head, the
+// storage is reused once the queue drains or its consumed half is compacted,
+// so a queue backed by a monotonic arena does not grow with every node freed.
+class MoveQueue
 {
 public:
 
-	Cube(unsigned int size = DEFAULT_SIZE);
-	~Cube();
+	explicit MoveQueue(std::pmr::memory_resource* resource);
 
-	unsigned int size;
-	unsigned int numberOfMoves = 0;
+	void reserve(size_t count);
+	void push_back(const QueuedMove& move);
+	void pop_front();
+	QueuedMove& front();
+	void clear();
 
-	void draw(SETTINGS settings, GLfloat deltaTime);
-	void rotate_face(int faceIndex, bool contrary, RotateDirection dir);
-	void scramble();
+	bool empty() const;
+	size_t size() const;
+
+	QueuedMove* begin();
+	QueuedMove* end();
 
 private:
 
-	std::vector<Piece*> pieces;
-	Shader shader;
-	unsigned int texture;
+	std::pmr::vector<QueuedMove> moves;
+	size_t head = 0;
+};
 
-	bool rotating = false;
-	std::vector<Piece*> rotatingFacePieces = {};
-	int rotatingFaceIndex = 0;
-	float totalRotationAngle = 0;
-	float currentRotationAngle = 0;
+// One slice turning. Several can run at once when they share an axis,
+// since slices along the same axis never share pieces.
+struct SliceAnimation {
+	int faceIndex;
+	RotateDirection dir;
+	float totalRotationAngle;
+	float currentRotationAngle;
+	float previousRotationAngle;
 	float rotationSpeed;
-	RotateDirection rotationDir;
+	unsigned int inputId;
+	double startTime;
+};
 
-	bool scrambling = false;
-	std::vector<RotationParams> rotParams = {};
+struct SliceSnapshot {
+	int faceIndex;
+	float previousRotationAngle;
+	float currentRotationAngle;
+	unsigned int inputId;
+	double startTime;
+};
+
+// A committed quarter turn and the state versions before and after it, so
+// consumers holding an older state can replay turns instead of rebuilding
+struct TurnRecord {
+	unsigned int fromVersion;
+	unsigned int toVersion;
+	int axis;
+	int layer;
+	bool positive;
+};
+
+// Immutable copy of everything the renderer needs to draw one simulation tick
+struct CubeSnapshot {
+	unsigned int cubeId = 0;
+	unsigned int size = 0;
+	unsigned int numberOfMoves = 0;
+	unsigned int stateVersion = 0;
+	PieceTransforms pieces;
+
+	// The last committed turns, oldest first, ending at stateVersion
+	std::vector<TurnRecord> turns = {};
+
+	RotateDirection rotationDir = line;
+	std::vector<SliceSnapshot> animations = {};
+	unsigned int queuedMoves = 0;
+	unsigned int historyMoves = 0;
+	bool historyComplete = true;
+
+	double tickTime = 0;
+	float tickDt = 0;
+};
+
+class Cube
+{
+public:
+
+	// Cubes that never solve, like those of a scene, can skip the move history
+	Cube(unsigned int size = DEFAULT_SIZE, bool recordHistory = true);
+
+	unsigned int size;
+	unsigned int numberOfMoves = 0;
+
+	void update(float deltaTime);
+	void rotate_face(int faceIndex, bool contrary, RotateDirection dir, unsigned int inputId = 0);
+	void apply_move(RotationParams params);
+	void scramble();
+	void solve();
+	void finish();
+	void set_turn_duration(float duration);
+	void fill_snapshot(CubeSnapshot& snapshot);
+	void get_facelets(uint8_t* facelets);
+	bool set_facelets(const uint8_t* facelets);
+
+	bool is_rotating();
+
+private:
 
-	void load_texture();
-	std::vector<Piece*> get_face_pieces(int faceIndex);
-	void update_face_rotation(GLfloat deltaTime);
+	// Everything the cube stores comes from one upstream block sized for it and
+	// is freed in one go with the cube. Declared first so it outlives its users.
+	std::pmr::monotonic_buffer_resource arena;
+
+	PieceTransforms pieces;
+
+	std::pmr::vector<SliceAnimation> animations;
+	MoveQueue moveQueue;
+	unsigned int inputBacklog = 0;
+	float turnDuration = DEFAULT_TURN_DURATION;
+
+	// Committed moves with inverse pairs cancelled, undone in reverse to solve.
+	// Reserved whole, past CUBE_HISTORY_LIMIT it is dropped and stops recording.
+	// historyComplete is false from the start when the cube records no history.
+	std::pmr::vector<RotationParams> history;
+	bool historyComplete = true;
+
+	// Changes whenever a piece moves, unique across cubes, so consumers of
+	// snapshots can tell when the resting pieces are worth copying again
+	unsigned int stateVersion;
+
+	// Ring of the last TURN_LOG_SIZE committed turns
+	TurnRecord turnLog[TURN_LOG_SIZE];
+	size_t turnCount = 0;
+
+	bool can_start(RotationParams& params);
+	void start_queued_moves();
+	void start_face_rotation(QueuedMove& move);
+	void update_face_rotation(SliceAnimation& animation, float deltaTime);
+	void end_face_rotation(SliceAnimation& animation);
+	void record_move(RotationParams params);
 };
 
+size_t cubePieceCount(unsigned int size);
+size_t cubeArenaBytes(unsigned int size, bool recordHistory = true);
 glm::vec3 roundToNearestHalf(glm::vec3 vec);
+float moveAngle(RotationParams params);
+glm::vec3 rotationAxis(RotateDirection dir);
+int rotationAxisIndex(RotateDirection dir);
+void pieceFacelets(unsigned int size, glm::vec3 home, glm::vec3 pos, uint8_t rotation, uint8_t* facelets);
+void snapshotFacelets(const CubeSnapshot& snapshot, uint8_t* facelets);
 
-#endif
\ No newline at end of file
+#endif
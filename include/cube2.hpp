@@ -0,0 +1,65 @@
+#ifndef CUBE2_HPP
+#define CUBE2_HPP
+
+#include <cube3.hpp>
+#include <mapped_file.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// A 2x2 is the corners of a 3x3. With the DBL corner held in place, U, R and F
+// turns reach every state once: 7! permutations times 3^6 twists.
+#define CUBE2_PERMS 5040
+#define CUBE2_TWISTS 729
+#define CUBE2_STATES (CUBE2_PERMS * CUBE2_TWISTS)
+#define CUBE2_MOVES 9
+#define CUBE2_MAX_DEPTH 16
+#define CUBE2_UNVISITED 3
+#define CUBE2_TABLE_MAGIC "RUBIK2D1"
+#define CUBE2_TABLE_PATH "cube2_distances.bin"
+
+struct Cube2TableHeader {
+	char magic[8];
+	uint32_t stateCount;
+	uint32_t maxDepth;
+	uint32_t distribution[CUBE2_MAX_DEPTH];
+};
+
+// Perfect hash of the corners, the DBL corner must be home. Moves are the
+// first CUBE2_MOVES Cube3 moves (U, R and F turns).
+uint32_t cube2Index(const Cube3& cube);
+Cube3 cube2State(uint32_t index);
+uint32_t cube2Move(uint32_t index, int move);
+
+// Depth of every 2x2 state, 2 bits each, stored modulo 3 (CUBE2_UNVISITED while
+// searching). Neighbors are always one level apart at most, so the residue alone
+// tells which move goes one level down, and solving is a walk of depth steps.
+class Cube2Table
+{
+public:
+
+	bool generate(unsigned int threads = 0);
+	bool save(const char* path) const;
+	bool load(const char* path);
+	bool is_ready() const { return distances != nullptr; }
+
+	int residue(uint32_t index) const { return (distances[index >> 2] >> ((index & 3) * 2)) & 3; }
+	int distance(uint32_t index) const;
+
+	// Solves any 2x2 state, given as the corners of cube, up to a whole cube
+	// rotation. The moves are Cube3 moves and may turn any of the six faces.
+	int solve(const Cube3& cube, uint8_t* solution, int maxLength) const;
+
+	const Cube2TableHeader& get_header() const { return header; }
+
+private:
+
+	Cube2TableHeader header = {};
+	std::vector<uint8_t> generated;
+	MappedFile file;
+	const uint8_t* distances = nullptr;
+
+	int next_move(uint32_t& index) const;
+};
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef CUBE3_HPP
+#define CUBE3_HPP
+
+#include <cstdint>
+#include <string>
+
+// CUBE3_SIMD comes from the build (RUBIKGL_SIMD), which also enables SSSE3 where needed
+#ifdef CUBE3_SIMD
+#include <tmmintrin.h>
+#endif
+
+#define CUBE3_MOVES 18
+
+enum Corner { URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB };
+enum Edge { UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR };
+
+// Face turns in U R F D L B order, each as quarter, half and inverse turn
+enum Move {
+	U1, U2, U3, R1, R2, R3, F1, F2, F3,
+	D1, D2, D3, L1, L2, L3, B1, B2, B3
+};
+
+// Move m as shuffle controls: slot i of the result takes the cubie in slot
+// shuffle[i] and adds twist[i] to its orientation. Unused lanes shuffle in zero.
+struct Cube3Move {
+	alignas(16) uint8_t cornerShuffle[16];
+	alignas(16) uint8_t cornerTwist[16];
+	alignas(16) uint8_t edgeShuffle[16];
+	alignas(16) uint8_t edgeFlip[16];
+};
+
+struct Cube3Tables {
+	Cube3Move moves[CUBE3_MOVES];
+};
+
+// Quarter turns from Kociemba's cubie definitions, in "replaced by" form
+constexpr uint8_t baseCornerPerm[6][8] = {
+	{ UBR, URF, UFL, ULB, DFR, DLF, DBL, DRB },
+	{ DFR, UFL, ULB, URF, DRB, DLF, DBL, UBR },
+	{ UFL, DLF, ULB, UBR, URF, DFR, DBL, DRB },
+	{ URF, UFL, ULB, UBR, DLF, DBL, DRB, DFR },
+	{ URF, ULB, DBL, UBR, DFR, UFL, DLF, DRB },
+	{ URF, UFL, UBR, DRB, DFR, DLF, ULB, DBL },
+};
+constexpr uint8_t baseCornerOri[6][8] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 2, 0, 0, 1, 1, 0, 0, 2 },
+	{ 1, 2, 0, 0, 2, 1, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 0, 0, 2, 1, 0 },
+	{ 0, 0, 1, 2, 0, 0, 2, 1 },
+};
+constexpr uint8_t baseEdgePerm[6][12] = {
+	{ UB, UR, UF, UL, DR, DF, DL, DB, FR, FL, BL, BR },
+	{ FR, UF, UL, UB, BR, DF, DL, DB, DR, FL, BL, UR },
+	{ UR, FL, UL, UB, DR, FR, DL, DB, UF, DF, BL, BR },
+	{ UR, UF, UL, UB, DF, DL, DB, DR, FR, FL, BL, BR },
+	{ UR, UF, BL, UB, DR, DF, FL, DB, FR, UL, DL, BR },
+	{ UR, UF, UL, BR, DR, DF, DL, BL, FR, FL, UB, DB },
+};
+constexpr uint8_t baseEdgeOri[6][12] = {
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1 },
+};
+
+constexpr Cube3Tables buildCube3Tables()
+{
+	Cube3Tables tables = {};
+
+	for (int face = 0; face < 6; face++)
+	{
+		// Start from the identity and compose the quarter turn 1, 2 and 3 times
+		uint8_t cp[8] = {}, co[8] = {}, ep[12] = {}, eo[12] = {};
+		for (int i = 0; i < 8; i++) cp[i] = i;
+		for (int i = 0; i < 12; i++) ep[i] = i;
+
+		for (int power = 0; power < 3; power++)
+		{
+			uint8_t ncp[8] = {}, nco[8] = {}, nep[12] = {}, neo[12] = {};
+			for (int i = 0; i < 8; i++)
+			{
+				ncp[i] = cp[baseCornerPerm[face][i]];
+				nco[i] = (co[baseCornerPerm[face][i]] + baseCornerOri[face][i]) % 3;
+			}
+			for (int i = 0; i < 12; i++)
+			{
+				nep[i] = ep[baseEdgePerm[face][i]];
+				neo[i] = (eo[baseEdgePerm[face][i]] + baseEdgeOri[face][i]) % 2;
+			}
+
+			Cube3Move& move = tables.moves[face * 3 + power];
+			for (int i = 0; i < 16; i++)
+			{
+				move.cornerShuffle[i] = i < 8 ? ncp[i] : 0x80;
+				move.cornerTwist[i] = i < 8 ? nco[i] * 8 : 0;
+				move.edgeShuffle[i] = i < 12 ? nep[i] : 0x80;
+				move.edgeFlip[i] = i < 12 ? neo[i] << 4 : 0;
+			}
+
+			for (int i = 0; i < 8; i++) { cp[i] = ncp[i]; co[i] = nco[i]; }
+			for (int i = 0; i < 12; i++) { ep[i] = nep[i]; eo[i] = neo[i]; }
+		}
+	}
+
+	return tables;
+}
+
+inline constexpr Cube3Tables cube3Tables = buildCube3Tables();
+
+// Headless 3x3 state at cubie level, packed for SSSE3: one byte per corner
+// (index + 8 * twist) and one byte per edge (index | flip << 4), each set in a
+// 128-bit lane. A face turn is one pshufb per lane plus an orientation fix-up.
+class Cube3
+{
+public:
+
+	alignas(16) uint8_t corners[16];
+	alignas(16) uint8_t edges[16];
+
+	Cube3()
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			corners[i] = i < 8 ? i : 0;
+			edges[i] = i < 12 ? i : 0;
+		}
+	}
+
+	inline void apply(int move)
+	{
+		const Cube3Move& m = cube3Tables.moves[move];
+
+#ifdef CUBE3_SIMD
+		__m128i c = _mm_load_si128((const __m128i*)corners);
+		__m128i e = _mm_load_si128((const __m128i*)edges);
+
+		c = _mm_shuffle_epi8(c, _mm_load_si128((const __m128i*)m.cornerShuffle));
+		c = _mm_add_epi8(c, _mm_load_si128((const __m128i*)m.cornerTwist));
+		// Twist is stored as a multiple of 8, so "mod 3" is "subtract 24 if >= 24"
+		c = _mm_min_epu8(c, _mm_sub_epi8(c, _mm_set1_epi8(24)));
+
+		e = _mm_shuffle_epi8(e, _mm_load_si128((const __m128i*)m.edgeShuffle));
+		e = _mm_xor_si128(e, _mm_load_si128((const __m128i*)m.edgeFlip));
+
+		_mm_store_si128((__m128i*)corners, c);
+		_mm_store_si128((__m128i*)edges, e);
+#else
+		uint8_t c[16], e[16];
+		for (int i = 0; i < 16; i++)
+		{
+			uint8_t twisted = (m.cornerShuffle[i] & 0x80 ? 0 : corners[m.cornerShuffle[i]]) + m.cornerTwist[i];
+			c[i] = twisted >= 24 ? twisted - 24 : twisted;
+			e[i] = (m.edgeShuffle[i] & 0x80 ? 0 : edges[m.edgeShuffle[i]]) ^ m.edgeFlip[i];
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			corners[i] = c[i];
+			edges[i] = e[i];
+		}
+#endif
+	}
+
+	bool operator==(const Cube3& other) const
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			if (corners[i] != other.corners[i] || edges[i] != other.edges[i])
+				return false;
+		}
+		return true;
+	}
+
+	bool is_solved() const
+	{
+		return *this == Cube3();
+	}
+
+	int corner_perm(int i) const { return corners[i] & 7; }
+	int corner_ori(int i) const { return corners[i] >> 3; }
+	int edge_perm(int i) const { return edges[i] & 15; }
+	int edge_ori(int i) const { return edges[i] >> 4; }
+
+	// Stops at the first token that is not a move, which is stored in rejected.
+	// The moves before it stay applied.
+	bool apply(const std::string& sequence, std::string* rejected = nullptr);
+	void scramble(unsigned int length, unsigned int seed);
+};
+
+int inverseMove(int move);
+const char* moveName(int move);
+int parseMove(const std::string& token);
+
+#endif
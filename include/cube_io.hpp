@@ -0,0 +1,33 @@
+#ifndef CUBE_IO_HPP
+#define CUBE_IO_HPP
+
+#include <cube3.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#define FACELET_CHARS "URFDLB"
+#define FACELET_BITS 3
+#define CUBE3_PACKED_BYTES 13
+
+// All functions work on caller-owned buffers and never allocate, so batch
+// tools can stream states through a single reusable buffer.
+
+// Facelet string: one URFDLB letter per sticker in URFDLB face order, 6*N*N letters
+size_t faceletStringLength(unsigned int size);
+unsigned int faceletStringSize(std::string_view text);
+bool writeFaceletString(std::span<const uint8_t> facelets, std::span<char> text);
+bool readFaceletString(std::string_view text, std::span<uint8_t> facelets);
+
+// Binary facelets: 3 bits per sticker, least significant bits first
+size_t packedFaceletBytes(unsigned int size);
+bool packFacelets(std::span<const uint8_t> facelets, std::span<uint8_t> bytes);
+bool unpackFacelets(std::span<const uint8_t> bytes, std::span<uint8_t> facelets);
+
+// Binary 3x3 at cubie level: 5 bits per corner and per edge, 100 bits in 13 bytes
+void packCube3(const Cube3& cube, std::span<uint8_t, CUBE3_PACKED_BYTES> bytes);
+Cube3 unpackCube3(std::span<const uint8_t, CUBE3_PACKED_BYTES> bytes);
+
+#endif
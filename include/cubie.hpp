@@ -0,0 +1,52 @@
+#ifndef CUBIE_HPP
+#define CUBIE_HPP
+
+#include <cube3.hpp>
+
+#include <cstdint>
+
+#define FACELET_COUNT 54
+
+enum CubeError {
+	cubeValid,
+	badFaceletColor,
+	unknownCorner,
+	unknownEdge,
+	duplicateCorner,
+	duplicateEdge,
+	cornerTwist,
+	edgeFlip,
+	parityError
+};
+
+// Unpacked 3x3 state: which cubie sits in each slot and how it is oriented.
+// Slots and cubies use the Corner / Edge order of Cube3.
+struct CubieCube {
+	uint8_t cp[8];
+	uint8_t co[8];
+	uint8_t ep[12];
+	uint8_t eo[12];
+};
+
+// Facelet indices of every corner and edge slot in the 54 URFDLB facelets,
+// the U/D facelet first for corners, the U/D or F/B facelet first for edges
+constexpr uint8_t cornerFacelets[8][3] = {
+	{ 8, 9, 20 }, { 6, 18, 38 }, { 0, 36, 47 }, { 2, 45, 11 },
+	{ 29, 26, 15 }, { 27, 44, 24 }, { 33, 53, 42 }, { 35, 17, 51 }
+};
+constexpr uint8_t edgeFacelets[12][2] = {
+	{ 5, 10 }, { 7, 19 }, { 3, 37 }, { 1, 46 }, { 32, 16 }, { 28, 25 },
+	{ 30, 43 }, { 34, 52 }, { 23, 12 }, { 21, 41 }, { 50, 39 }, { 48, 14 }
+};
+
+CubieCube toCubie(const Cube3& cube);
+Cube3 fromCubie(const CubieCube& cubie);
+
+CubeError faceletsToCubie(const uint8_t* facelets, CubieCube& cubie);
+void cubieToFacelets(const CubieCube& cubie, uint8_t* facelets);
+
+CubeError validate(const CubieCube& cubie);
+CubeError validate(const Cube3& cube);
+const char* cubeErrorName(CubeError error);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef DATASET_HPP
+#define DATASET_HPP
+
+#include <cube3.hpp>
+#include <cube_io.hpp>
+#include <mapped_file.hpp>
+
+#include <cstdint>
+
+#define DATASET_MAGIC "RUBIKDS1"
+#define DATASET_VERSION 1
+#define DATASET_MAX_SOLUTION 30
+#define DATASET_BATCH 4096
+#define DATASET_NO_MOVE 0xFF
+
+// The file is a header followed by fixed-size records, record i lives at
+// recordOffset + i * recordSize so any record can be read without an index scan.
+struct DatasetHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t recordSize;
+	uint64_t recordOffset;
+	uint64_t recordCount;
+	uint64_t seed;
+	uint32_t scrambleLength;
+	uint32_t exactDistances;
+};
+
+// state is the packed Cube3, solution holds Cube3 move indices padded with DATASET_NO_MOVE
+struct DatasetRecord {
+	uint8_t state[CUBE3_PACKED_BYTES];
+	uint8_t distance;
+	uint8_t solution[DATASET_MAX_SOLUTION];
+};
+
+// Writes solution moves for state and returns how many, or -1 when it gives up.
+// Called from every worker thread at once, so it must not share mutable state.
+typedef int (*StateSolver)(const Cube3& state, uint8_t* solution, int maxLength);
+
+struct DatasetOptions {
+	uint64_t recordCount = 0;
+	uint64_t seed = 1;
+	unsigned int scrambleLength = 25;
+	unsigned int threads = 0;
+	StateSolver solver = nullptr;
+	bool exactSolver = false;
+};
+
+// Without a solver the solution is the inverted scramble, an upper bound on the distance
+bool writeDataset(const char* path, const DatasetOptions& options);
+int randomScramble(uint64_t seed, uint64_t index, unsigned int length, uint8_t* moves);
+
+class DatasetReader
+{
+public:
+
+	bool open(const char* path);
+
+	const DatasetHeader& header() const { return *(const DatasetHeader*)file.data(); }
+	uint64_t size() const { return header().recordCount; }
+	const DatasetRecord& record(uint64_t index) const;
+
+private:
+
+	MappedFile file;
+};
+
+#endif
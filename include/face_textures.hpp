@@ -0,0 +1,65 @@
+#ifndef FACE_TEXTURES_HPP
+#define FACE_TEXTURES_HPP
+
+#include <glew.h>
+
+#include <sticker_faces.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#define FACE_STREAM_REGIONS 3
+
+// One copy from the staging buffer into a rectangle of a face layer
+struct FaceUpload {
+	int face;
+	unsigned int x, y, width, height;
+	size_t offset;
+};
+
+// The sticker faces of a cube as layers of one R8UI texture array. Only the
+// rows, columns and faces a turn changed are uploaded, packed tightly through
+// a pixel buffer. With ARB_buffer_storage the buffer is mapped once, split in
+// FACE_STREAM_REGIONS regions used in turn and fenced so the CPU never writes
+// bytes the GPU has not read yet. Otherwise the buffer is orphaned per upload.
+// Must only be used from the thread that owns the GL context.
+class FaceTextures
+{
+public:
+
+	FaceTextures();
+	~FaceTextures();
+
+	FaceTextures(const FaceTextures&) = delete;
+	FaceTextures& operator=(const FaceTextures&) = delete;
+
+	void update(const CubeSnapshot& snapshot);
+	unsigned int get_texture() const;
+
+	// Bytes sent to the GPU by the last update that changed anything
+	size_t get_uploaded_bytes() const;
+
+private:
+
+	StickerFaces faces;
+	unsigned int texture = 0;
+	unsigned int textureSize = 0;
+
+	unsigned int pbo = 0;
+	bool persistent;
+	uint8_t* mapped = nullptr;
+	size_t regionBytes = 0;
+	int region = 0;
+	GLsync fences[FACE_STREAM_REGIONS] = {};
+
+	std::vector<FaceUpload> uploads = {};
+	size_t uploadedBytes = 0;
+
+	void allocate(unsigned int size);
+	void release_buffer();
+	uint8_t* begin_region();
+	bool end_region(size_t bytes);
+	bool upload();
+};
+
+#endif
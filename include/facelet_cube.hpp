@@ -0,0 +1,249 @@
+#ifndef FACELET_CUBE_HPP
+#define FACELET_CUBE_HPP
+
+#include <cube.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#define MIN_TEMPLATE_SIZE 2
+#define MAX_TEMPLATE_SIZE 7
+
+// Faces in the standard URFDLB facelet order
+enum FaceName { faceU, faceR, faceF, faceD, faceL, faceB };
+
+// Quarter turns are +90 degrees about the positive axis (right-hand rule), the
+// same convention as Cube::rotate_face. axis: 0 = x (col), 1 = y (line), 2 = z (face)
+struct SliceMove {
+	uint8_t axis;
+	uint8_t turns;
+	uint16_t layer;
+};
+
+struct StickerPos {
+	int x, y, z;
+	int face;
+};
+
+// Sticker geometry in doubled integer coordinates so even sizes stay exact.
+// Facelets of a face are numbered row by row as in the URFDLB facelet string:
+// U seen from above with F at the bottom, D seen from below with F at the top,
+// side faces seen from outside with U at the top.
+constexpr StickerPos stickerPosition(int n, int index)
+{
+	int face = index / (n * n);
+	int row = (index % (n * n)) / n;
+	int col = index % n;
+	int m = n - 1;
+
+	switch (face) {
+	case faceU: return { -m + 2 * col, m, -m + 2 * row, face };
+	case faceR: return { m, m - 2 * row, m - 2 * col, face };
+	case faceF: return { -m + 2 * col, m - 2 * row, m, face };
+	case faceD: return { -m + 2 * col, -m, m - 2 * row, face };
+	case faceL: return { -m, m - 2 * row, -m + 2 * col, face };
+	default:    return { m - 2 * col, m - 2 * row, -m, face };
+	}
+}
+
+constexpr int stickerIndex(int n, StickerPos p)
+{
+	int m = n - 1;
+	int row = 0, col = 0;
+
+	switch (p.face) {
+	case faceU: row = (p.z + m) / 2; col = (p.x + m) / 2; break;
+	case faceR: row = (m - p.y) / 2; col = (m - p.z) / 2; break;
+	case faceF: row = (m - p.y) / 2; col = (p.x + m) / 2; break;
+	case faceD: row = (m - p.z) / 2; col = (p.x + m) / 2; break;
+	case faceL: row = (m - p.y) / 2; col = (p.z + m) / 2; break;
+	default:    row = (m - p.y) / 2; col = (m - p.x) / 2; break;
+	}
+
+	return p.face * n * n + row * n + col;
+}
+
+constexpr int rotateFace(int face, int axis)
+{
+	// Where a face normal goes under +90 degrees about the axis
+	constexpr int aboutX[6] = { faceF, faceR, faceD, faceB, faceL, faceU };
+	constexpr int aboutY[6] = { faceU, faceB, faceR, faceD, faceF, faceL };
+	constexpr int aboutZ[6] = { faceL, faceU, faceF, faceR, faceD, faceB };
+
+	return axis == 0 ? aboutX[face] : axis == 1 ? aboutY[face] : aboutZ[face];
+}
+
+constexpr StickerPos rotateSticker(StickerPos p, int axis)
+{
+	int face = rotateFace(p.face, axis);
+
+	if (axis == 0) return { p.x, -p.z, p.y, face };
+	if (axis == 1) return { p.z, p.y, -p.x, face };
+	return { -p.y, p.x, p.z, face };
+}
+
+constexpr int stickerLayer(int n, StickerPos p, int axis)
+{
+	int coord = axis == 0 ? p.x : axis == 1 ? p.y : p.z;
+	return (coord + n - 1) / 2;
+}
+
+// Every quarter turn as 4-cycles of facelet indices, computed at compile time
+template <unsigned int N>
+struct FaceletTables {
+	static constexpr int STICKERS = 6 * N * N;
+	static constexpr int MAX_CYCLES = N + (N * N) / 4;
+
+	uint16_t cycles[3 * N][MAX_CYCLES][4];
+	uint16_t cycleCount[3 * N];
+};
+
+template <unsigned int N>
+constexpr FaceletTables<N> buildFaceletTables()
+{
+	FaceletTables<N> tables = {};
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int layer = 0; layer < (int)N; layer++)
+		{
+			int move = axis * N + layer;
+			bool visited[6 * N * N] = {};
+
+			for (int i = 0; i < (int)(6 * N * N); i++)
+			{
+				StickerPos p = stickerPosition(N, i);
+				if (visited[i] || stickerLayer(N, p, axis) != layer) continue;
+
+				uint16_t cycle[4] = {};
+				for (int k = 0; k < 4; k++)
+				{
+					cycle[k] = (uint16_t)stickerIndex(N, p);
+					visited[cycle[k]] = true;
+					p = rotateSticker(p, axis);
+				}
+
+				// The center of an odd face maps onto itself
+				if (cycle[1] == cycle[0]) continue;
+
+				for (int k = 0; k < 4; k++)
+					tables.cycles[move][tables.cycleCount[move]][k] = cycle[k];
+				tables.cycleCount[move]++;
+			}
+		}
+	}
+
+	return tables;
+}
+
+template <unsigned int N>
+inline constexpr FaceletTables<N> faceletTables = buildFaceletTables<N>();
+
+// Sticker-level NxN state with the size fixed at compile time, so move loops
+// are fully unrolled over constant tables with no size branches.
+template <unsigned int N>
+class FaceletCube
+{
+public:
+
+	static constexpr int STICKERS = 6 * N * N;
+
+	uint8_t facelets[STICKERS];
+
+	FaceletCube()
+	{
+		for (int i = 0; i < STICKERS; i++)
+			facelets[i] = (uint8_t)(i / (N * N));
+	}
+
+	inline void apply(SliceMove move)
+	{
+		const auto& t = faceletTables<N>;
+		int index = move.axis * N + move.layer;
+		int shift = move.turns & 3;
+
+		for (int c = 0; c < t.cycleCount[index]; c++)
+		{
+			const uint16_t* cycle = t.cycles[index][c];
+			uint8_t v[4] = { facelets[cycle[0]], facelets[cycle[1]], facelets[cycle[2]], facelets[cycle[3]] };
+
+			// Content of cycle[k] moves to cycle[k + shift]
+			for (int k = 0; k < 4; k++)
+				facelets[cycle[(k + shift) & 3]] = v[k];
+		}
+	}
+
+	bool is_solved() const
+	{
+		for (int i = 0; i < STICKERS; i++)
+		{
+			if (facelets[i] != facelets[(i / (N * N)) * N * N])
+				return false;
+		}
+		return true;
+	}
+};
+
+// Size-erased handle; the virtual call happens once per batch of moves
+class FaceletEngine
+{
+public:
+
+	virtual ~FaceletEngine() {}
+
+	virtual void apply(const SliceMove* moves, size_t count) = 0;
+	virtual unsigned int size() const = 0;
+	virtual uint8_t* facelets() = 0;
+	virtual bool is_solved() const = 0;
+};
+
+template <unsigned int N>
+class FaceletEngineN : public FaceletEngine
+{
+public:
+
+	void apply(const SliceMove* moves, size_t count) override
+	{
+		for (size_t i = 0; i < count; i++)
+			cube.apply(moves[i]);
+	}
+
+	unsigned int size() const override { return N; }
+	uint8_t* facelets() override { return cube.facelets; }
+	bool is_solved() const override { return cube.is_solved(); }
+
+private:
+
+	FaceletCube<N> cube;
+};
+
+// Fallback for sizes without an instantiation, tables are built at runtime
+class FaceletEngineDynamic : public FaceletEngine
+{
+public:
+
+	FaceletEngineDynamic(unsigned int n);
+
+	void apply(const SliceMove* moves, size_t count) override;
+	unsigned int size() const override { return n; }
+	uint8_t* facelets() override { return state.data(); }
+	bool is_solved() const override;
+
+private:
+
+	unsigned int n;
+	std::vector<uint8_t> state;
+	std::vector<uint32_t> cycles;
+	std::vector<uint32_t> cycleStart;
+};
+
+// A headless sticker model for batch work such as benchmarks and dataset style
+// move replay. Cube keeps its piece model for animation and does not use it,
+// Cube::get_facelets is the bridge between the two.
+std::unique_ptr<FaceletEngine> makeFaceletEngine(unsigned int size);
+SliceMove toSliceMove(RotationParams params);
+SliceMove faceTurn(int move, unsigned int size);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+#include <glfw3.h>
+
+#include <settings.hpp>
+
+#define PACER_ACTIVE_TIME 0.25
+#define PACER_STATS_PERIOD 1.0
+#define MAX_FRAME_CAP 240
+#define MIN_IDLE_WAIT 0.1f
+#define MAX_IDLE_WAIT 5.0f
+
+// What the frame loop cost over the last stats period
+struct PacerStats {
+	float framesPerSecond = 0;
+	float workPercent = 0;
+	float waitPercent = 0;
+	float idlePercent = 0;
+};
+
+// Decides how the main loop waits between frames. While something moves, or
+// shortly after any input, frames follow each other at the frame cap (or
+// vsync). Otherwise the loop sleeps in glfwWaitEventsTimeout until an event
+// arrives, redrawing only every idleWait seconds so the UI stats stay fresh.
+class FramePacer
+{
+public:
+
+	FramePacer();
+
+	// Something is moving or just changed, keep drawing for a moment
+	void keep_awake();
+	bool is_idle(const SETTINGS& settings) const;
+
+	// Called after the buffer swap, returns once the next frame should start
+	void end_frame(const SETTINGS& settings);
+
+	const PacerStats& get_stats() const;
+
+private:
+
+	double frameStart;
+	double awakeUntil;
+
+	double periodStart;
+	double workTime = 0;
+	double waitTime = 0;
+	double idleTime = 0;
+	unsigned int frames = 0;
+
+	PacerStats stats;
+
+	void wait_until(double time);
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef KEYMAP_HPP
+#define KEYMAP_HPP
+
+#include <glfw3.h>
+#include <cube.hpp>
+
+#define ORIENTATION_COUNT 24
+#define MIDDLE_LAYER -1
+
+// Sides of the cube as seen by the viewer
+enum ViewFace { viewRight, viewLeft, viewUp, viewDown, viewFront, viewBack };
+enum KeyGroup { linesGroup, colsGroup, facesGroup };
+
+// depth is counted from the viewer side: 0 = outer layer, 1 = first inner layer
+struct KeyBinding {
+	int key;
+	const char* keyName;
+	const char* name;
+	const char* notation;
+	ViewFace side;
+	int depth;
+	KeyGroup group;
+};
+
+// A signed cube axis, the direction a viewer side points to in cube space
+struct FaceAxis {
+	RotateDirection dir;
+	int sign;
+};
+
+// Maps (key, view orientation) to a move with table lookups only. The 24
+// possible orientations of the cube relative to the viewer are enumerated once;
+// the float camera math runs only when the view orientation changes.
+class Keymap
+{
+public:
+
+	Keymap();
+
+	int view_orientation(float rotationAngle, float flipAngle);
+	const KeyBinding* find(int key);
+	bool to_move(const KeyBinding& binding, int orientation, unsigned int cubeSize, bool inverse, RotationParams& params);
+	bool is_available(const KeyBinding& binding, unsigned int cubeSize);
+
+	const KeyBinding* get_bindings();
+	int get_binding_count();
+
+private:
+
+	FaceAxis orientations[ORIENTATION_COUNT][6];
+	int orientationIndex[6][6];
+	int keyToBinding[GLFW_KEY_LAST + 1];
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef LATENCY_HPP
+#define LATENCY_HPP
+
+#include <cube.hpp>
+#include <timestep.hpp>
+
+#include <vector>
+
+#define LATENCY_HISTORY 1024
+#define LATENCY_MAX_PENDING 64
+#define LATENCY_TIMEOUT 2.0
+#define LATENCY_BUCKETS 25
+#define LATENCY_BUCKET_MS 4.0f
+#define LATENCY_CSV_PATH "latency.csv"
+
+// Timestamps of one key press on its way to the screen, all from simulationClock()
+struct LatencySample {
+	unsigned int inputId;
+	double keyTime;
+	double simStartTime;
+	double firstFrameTime;
+	double swapTime;
+	bool vsync;
+};
+
+struct LatencyStats {
+	unsigned int count;
+	float mean;
+	float p50;
+	float p95;
+	float max;
+};
+
+// Follows key presses through the move queue to the first frame drawing their
+// slice in motion and to the buffer swap that presents it. Render thread only.
+class LatencyTracker
+{
+public:
+
+	bool enabled = false;
+
+	unsigned int key_pressed(double keyTime);
+	void frame_rendered(const CubeSnapshot& snapshot);
+	void frame_presented(bool vsync);
+
+	void clear();
+	bool export_csv(const char* path);
+
+	LatencyStats get_stats(bool toSwap);
+	void get_histogram(float* buckets, bool toSwap);
+
+private:
+
+	unsigned int nextInputId = 1;
+	std::vector<LatencySample> pending = {};
+	std::vector<LatencySample> inFrame = {};
+	std::vector<LatencySample> samples = {};
+	size_t nextSample = 0;
+
+	float latency_ms(LatencySample& sample, bool toSwap);
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstdint>
+
+// Whole-file memory mapping, read-only or read-write. Pages are loaded by the OS
+// on first touch, so files far larger than RAM can be accessed at random.
+class MappedFile
+{
+public:
+
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open_read(const char* path);
+	bool create(const char* path, uint64_t size);
+	bool flush();
+	void close();
+
+	bool is_open() const { return mapping != nullptr; }
+	uint8_t* data() { return mapping; }
+	const uint8_t* data() const { return mapping; }
+	uint64_t size() const { return length; }
+
+private:
+
+	uint8_t* mapping = nullptr;
+	uint64_t length = 0;
+
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fd = -1;
+#endif
+};
+
+#endif
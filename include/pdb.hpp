@@ -0,0 +1,79 @@
+#ifndef PDB_HPP
+#define PDB_HPP
+
+#include <cube3.hpp>
+#include <mapped_file.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#define PDB_MAGIC "RUBIKPDB"
+#define PDB_VERSION 1
+#define PDB_MAX_EDGES 7
+#define PDB_MAX_DEPTH 16
+#define PDB_UNVISITED 0xF
+
+#define CORNER_PERMS 40320
+#define CORNER_TWISTS 2187
+#define CORNER_PDB_STATES ((uint64_t)CORNER_PERMS * CORNER_TWISTS)
+
+enum PdbKind { cornerPdb, edgePdb };
+
+// nibbleFormat stores the exact distance in 4 bits. mod3Format stores it modulo 3
+// in 2 bits: a move changes the distance by at most one, so the residue recovers
+// the exact value from the parent's distance and the table halves in size.
+enum PdbFormat { nibbleFormat, mod3Format };
+
+// Which cubies the pattern keeps. Edge patterns track where each listed edge
+// is and how it is flipped, every other cubie is ignored.
+struct PdbSpec {
+	PdbKind kind;
+	uint8_t edgeCount;
+	uint8_t edges[PDB_MAX_EDGES];
+};
+
+struct PdbHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t format;
+	PdbSpec spec;
+	uint64_t stateCount;
+	uint32_t maxDepth;
+	uint64_t distribution[PDB_MAX_DEPTH];
+};
+
+PdbSpec cornerSpec();
+PdbSpec edgeSpec(int count);
+uint64_t pdbStateCount(const PdbSpec& spec);
+
+// Known kind, 1 to PDB_MAX_EDGES edges for edge patterns, each a distinct edge id
+bool pdbSpecValid(const PdbSpec& spec);
+uint64_t pdbIndex(const PdbSpec& spec, const Cube3& cube);
+
+class PatternDatabase
+{
+public:
+
+	bool generate(const PdbSpec& spec, unsigned int threads = 0);
+	bool save(const char* path, PdbFormat format) const;
+	bool load(const char* path);
+	bool is_ready() const { return data != nullptr; }
+
+	// Exact distance of a state. mod3 tables need the distance of a neighbor of it.
+	int distance(uint64_t index) const;
+	int distance(uint64_t index, int parentDistance) const;
+	int lookup(const Cube3& cube) const;
+
+	const PdbHeader& get_header() const { return header; }
+
+private:
+
+	PdbHeader header = {};
+	std::vector<uint8_t> generated;
+	MappedFile file;
+	const uint8_t* data = nullptr;
+
+	int residue(uint64_t index) const;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef PIECE_TRANSFORMS_HPP
+#define PIECE_TRANSFORMS_HPP
+
+#include <glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIECE_SIMD
+#include <emmintrin.h>
+#endif
+
+#define PIECE_LANES 4
+#define PIECE_ALIGNMENT 16
+#define PIECE_FLOAT_ARRAYS 6
+#define CUBE_ROTATIONS 24
+
+// Structure-of-arrays transforms of every piece of a cube: home and current
+// position per axis, and the orientation as an index into the 24 rotations of
+// a cube. The arrays share one aligned block and are padded to a whole number
+// of SIMD lanes, so slice loops run over contiguous registers with no gathers.
+// The block comes from the given memory resource, copies use the default one.
+class PieceTransforms
+{
+public:
+
+	explicit PieceTransforms(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	PieceTransforms(const PieceTransforms& other);
+	PieceTransforms& operator=(const PieceTransforms& other);
+	~PieceTransforms();
+
+	void reserve(size_t count);
+	size_t size() const;
+	bool empty() const;
+
+	// Grows or shrinks to count pieces, new ones rest at the origin
+	void resize(size_t count);
+
+	// Overwrites the pieces from index first on with every piece of other
+	void copy_pieces(size_t first, const PieceTransforms& other);
+
+	// Appends a piece resting at home with the identity orientation
+	void add(glm::vec3 home);
+
+	glm::vec3 get_home(size_t index) const;
+	glm::vec3 get_pos(size_t index) const;
+	void set_pos(size_t index, glm::vec3 pos);
+	uint8_t get_rotation(size_t index) const;
+	void set_rotation(size_t index, uint8_t rotation);
+	glm::quat get_orientation(size_t index) const;
+
+	// The whole block, arrays at their offsets from it, for direct GPU upload
+	const void* block() const;
+	size_t block_bytes() const;
+
+	const float* home_array(int axis) const;
+	const float* pos_array(int axis) const;
+	const uint8_t* rotation_array() const;
+
+	// Commits a quarter turn of every piece whose position on axis equals layer,
+	// by +90 degrees about the axis when positive and -90 otherwise
+	void turn_slice(int axis, float layer, bool positive);
+
+private:
+
+	std::pmr::memory_resource* resource;
+	float* data;
+	size_t count;
+	size_t stride;
+
+	float* array(int index);
+	const float* array(int index) const;
+	uint8_t* rotations();
+	const uint8_t* rotations() const;
+	void allocate(size_t newStride);
+};
+
+// The 24 rotations of a cube. Index 0 is the identity, turning a piece is a
+// table lookup and the exact matrix or quaternion is only built when needed.
+const glm::quat& rotationQuat(uint8_t rotation);
+const glm::mat3& rotationMatrix(uint8_t rotation);
+uint8_t rotationIndex(glm::quat orientation);
+uint8_t turnRotation(uint8_t rotation, int axis, bool positive);
+
+// Bytes of the block holding count pieces, alignment padding included
+size_t pieceBlockBytes(size_t count);
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef RENDERER_HPP
+#define RENDERER_HPP
+
+#include <glew.h>
+#include <glfw3.h>
+#include <shader_manager.hpp>
+#include <stb_image.h>
+
+#include <glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cube.hpp>
+#include <scene.hpp>
+#include <camera.hpp>
+#include <startup.hpp>
+#include <face_textures.hpp>
+#include <timestep.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+#define VSHADER_PATH "resources/shaders/basicCube.vert"
+#define FSHADER_PATH "resources/shaders/basicCube.frag"
+#define TEXT_PATH "resources/textures/cubeTexture.png"
+#define LOD_VSHADER_PATH "resources/shaders/lodFaces.vert"
+#define LOD_FSHADER_PATH "resources/shaders/lodFaces.frag"
+#define SCENE_VSHADER_PATH "resources/shaders/sceneCubes.vert"
+
+#define CUBE_WORLD_SIZE 1.5f
+#define LOD_STICKER_PIXELS 4.0f
+#define LOD_HYSTERESIS 1.25f
+#define SCENE_WORLD_SIZE 4.0f
+#define SCENE_CUBE_SPACING 1.5f
+
+// Pixels of the cube texture, decoded off the render thread
+struct DecodedImage {
+	unsigned char* data = nullptr;
+	int width = 0;
+	int height = 0;
+	double decodeMs = 0.0;
+};
+
+// Per cube data of a scene, where the cube stands with its slice axis in w and
+// the angle of each of its layers, laid out as the instanced attributes read it
+struct SceneCubeInstance {
+	glm::vec4 cube;
+	float layerAngles[SCENE_MAX_SIZE];
+};
+
+// Owns every GL resource of the cube and draws it from simulation snapshots.
+// Must only be used from the thread that owns the GL context. Nothing slow
+// happens before the first frame: the texture is decoded on a worker thread
+// and the shaders are only requested by the first draw, the cube appears as
+// soon as both are ready.
+// Once stickers shrink below LOD_STICKER_PIXELS on screen, each face is drawn
+// as one quad reading an NxN texture of sticker colors instead of one cube per
+// piece. Only the pieces on and next to turning slices are still drawn whole.
+// A scene of many cubes is drawn in a single instanced call over the pieces of
+// all its cubes, each cube turning its own slices.
+class Renderer
+{
+public:
+
+	Renderer(StartupProfile& startup);
+	~Renderer();
+
+	// Returns false while the cube cannot be drawn yet
+	bool draw(const CubeSnapshot& snapshot, const Camera& camera, float alpha);
+	bool draw_scene(const SceneSnapshot& scene, const Camera& camera, float alpha);
+
+private:
+
+	StartupProfile& startup;
+	ShaderManager shaders;
+	int cubeShader = -1;
+	unsigned int shaderGeneration = 0;
+	double shaderRequestTime = 0.0;
+
+	unsigned int texture = 0;
+	DecodedImage image;
+	std::atomic<bool> imageReady = false;
+	std::thread imageThread;
+
+	int viewLoc;
+	int projectionLoc;
+	int textureLoc;
+	int cubeScaleLoc;
+	int layerOffsetLoc;
+	int sliceAxisLoc;
+	int sliceCountLoc;
+	int sliceLayersLoc;
+	int sliceAnglesLoc;
+	int lodCullLoc;
+
+	int lodShader = -1;
+	unsigned int lodGeneration = 0;
+	int lodViewLoc;
+	int lodProjectionLoc;
+	int lodCubeScaleLoc;
+	int lodCubeSizeLoc;
+	int lodSliceAxisLoc;
+	int lodSliceCountLoc;
+	int lodSliceLayersLoc;
+
+	unsigned int VAO = 0;
+	unsigned int VBO = 0;
+	unsigned int maskVBO = 0;
+	unsigned int instanceVBO = 0;
+
+	unsigned int meshCubeId = 0;
+	unsigned int instanceVersion = 0;
+	size_t instanceCount = 0;
+	size_t instanceBytes = 0;
+
+	bool lodActive = false;
+	unsigned int lodVAO = 0;
+	FaceTextures faces;
+
+	int sceneShader = -1;
+	unsigned int sceneGeneration = 0;
+	int sceneViewLoc;
+	int sceneProjectionLoc;
+	int sceneCubeScaleLoc;
+	int sceneLayerOffsetLoc;
+
+	unsigned int sceneVAO = 0;
+	unsigned int sceneMaskVBO = 0;
+	unsigned int scenePieceVBO = 0;
+	unsigned int sceneCubeVBO = 0;
+
+	unsigned int sceneLayoutId = 0;
+	unsigned int sceneVersion = 0;
+	size_t scenePieceBytes = 0;
+	float sceneCubeScale = 0.0f;
+	std::vector<SceneCubeInstance> sceneCubes;
+
+	int sliceLayers[MAX_PARALLEL_SLICES] = {};
+	float sliceAngles[MAX_PARALLEL_SLICES] = {};
+
+	bool is_ready();
+	bool use_lod(unsigned int size, const Camera& camera);
+	void bind_shader();
+	void bind_lod_shader();
+	void bind_scene_shader();
+	void decode_texture();
+	void upload_texture();
+	void build_mesh();
+	void build_instances(const CubeSnapshot& snapshot);
+	void build_scene(const SceneSnapshot& scene);
+};
+
+#endif
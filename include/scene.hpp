@@ -0,0 +1,117 @@
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <cube.hpp>
+#include <timestep.hpp>
+#include <spsc_queue.hpp>
+#include <triple_buffer.hpp>
+
+#include <atomic>
+#include <barrier>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define DEFAULT_SCENE_CUBES 1000
+#define SCENE_MAX_CUBES 4096
+#define SCENE_MAX_SIZE 8
+#define SCENE_COMMAND_QUEUE_SIZE 64
+
+enum SceneCommandType { sceneLayoutCommand, sceneTickRateCommand, sceneTurnDurationCommand };
+
+// value holds the number of cubes of a layout, the tick rate or the turn
+// duration in milliseconds. size is only used by layouts.
+struct SceneCommand {
+	SceneCommandType type;
+	int value;
+	unsigned int size = 0;
+};
+
+// Immutable copy of every cube of the scene at one tick. Each cube has its own
+// snapshot for its turning slices, and the pieces of all of them are gathered
+// cube after cube in one block, so the renderer uploads the scene at once.
+struct SceneSnapshot {
+	unsigned int layoutId = 0;
+	unsigned int size = 0;
+	size_t piecesPerCube = 0;
+	std::vector<CubeSnapshot> cubes = {};
+
+	// Changes whenever the block of pieces does
+	unsigned int stateVersion = 0;
+	PieceTransforms pieces;
+
+	// Wall time of the last tick over all workers, snapshot included
+	unsigned int threads = 0;
+	double updateMs = 0;
+
+	double tickTime = 0;
+	float tickDt = 0;
+};
+
+// Many independent cubes, each turning random slices for as long as the scene
+// runs. A coordinator thread ticks them at a fixed rate and splits the cubes
+// between itself and worker threads, which update and copy their share in
+// parallel. Like Simulation, the render thread only sends commands and reads
+// the latest published SceneSnapshot.
+class Scene
+{
+public:
+
+	// threads counts the coordinator, 0 uses every core but one left to rendering
+	explicit Scene(unsigned int threads = 0);
+	~Scene();
+
+	void start();
+	void stop();
+
+	// Render thread API, commands are only sent when the value changes
+	void set_layout(unsigned int cubeCount, unsigned int size);
+	void set_tick_rate(int tickRate);
+	void set_turn_duration(float duration);
+
+	const SceneSnapshot& get_snapshot();
+	float get_alpha(const SceneSnapshot& snapshot);
+
+private:
+
+	unsigned int threadCount;
+	std::vector<std::unique_ptr<Cube>> cubes;
+	unsigned int cubeSize = DEFAULT_SIZE;
+	unsigned int layoutId = 0;
+	unsigned int stateCounter = 0;
+	FixedTimestep timestep;
+	float turnDuration = DEFAULT_TURN_DURATION;
+
+	unsigned int requestedCubes = 0;
+	unsigned int requestedSize = 0;
+	int requestedTickRate = DEFAULT_TICK_RATE;
+	int requestedTurnDuration = (int)(DEFAULT_TURN_DURATION * 1000);
+
+	std::thread thread;
+	std::vector<std::thread> workers;
+	std::atomic<bool> running = false;
+
+	// Shared with the workers for one tick, written by the coordinator before
+	// the start barrier and read back after the done barrier
+	std::barrier<> tickStart;
+	std::barrier<> tickDone;
+	bool stopping = false;
+	int pendingTicks = 0;
+	SceneSnapshot* target = nullptr;
+	std::atomic<bool> copied = false;
+	std::vector<std::mt19937> generators;
+
+	SpscQueue<SceneCommand, SCENE_COMMAND_QUEUE_SIZE> commands;
+	TripleBuffer<SceneSnapshot> snapshots;
+
+	void run();
+	void work(unsigned int worker);
+	void update_cubes(unsigned int worker);
+	bool process_commands();
+	void build_cubes(unsigned int cubeCount, unsigned int size);
+	void publish(int ticks, double tickTime);
+	void send(SceneCommand command);
+};
+
+#endif
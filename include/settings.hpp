@@ -10,6 +10,15 @@ struct SETTINGS
 	float flipAngle = 0;
 	float zoom = 3;
 	bool msaa = true;
+	int tickRate = 120;
+	float turnDuration = 0.2f;
+	bool vsync = true;
+	bool measureLatency = false;
+	bool idleThrottle = true;
+	int frameCap = 0;
+	float idleWait = 1.0f;
+	bool showScene = false;
+	int sceneCubes = 1000;
 };
 
 #endif
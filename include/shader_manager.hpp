@@ -0,0 +1,80 @@
+#ifndef SHADER_MANAGER_HPP
+#define SHADER_MANAGER_HPP
+
+#include <glew.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define SHADER_CACHE_DIR "shader_cache"
+#define SHADER_POLL_INTERVAL 0.5
+
+// Vertex and fragment program loaded from two source files
+struct ShaderProgram {
+	std::string vertexPath;
+	std::string fragmentPath;
+	std::filesystem::file_time_type vertexTime;
+	std::filesystem::file_time_type fragmentTime;
+
+	unsigned int program = 0;
+	unsigned int generation = 0;
+
+	// Rebuild in flight after a source change, swapped in once it links
+	unsigned int pending = 0;
+	uint64_t pendingKey = 0;
+};
+
+// Owns the linked programs of the renderer. Linked programs are saved with
+// glGetProgramBinary under a hash of their sources and of the driver, so later
+// starts load them back instead of compiling. The source files are polled for
+// changes and rebuilt without blocking the frame when KHR_parallel_shader_compile
+// is available. A rebuilt program replaces the old one only when it links, and
+// bumps the generation so users know to fetch their uniform locations again.
+// Must only be used from the thread that owns the GL context.
+class ShaderManager
+{
+public:
+
+	explicit ShaderManager(const char* cacheDir = SHADER_CACHE_DIR);
+	~ShaderManager();
+
+	ShaderManager(const ShaderManager&) = delete;
+	ShaderManager& operator=(const ShaderManager&) = delete;
+
+	// Returns the handle of a new program. A cached binary is loaded right away,
+	// otherwise the program is built in the background and stays 0 until
+	// update() finds it linked.
+	int load(const char* vertexPath, const char* fragmentPath);
+
+	unsigned int program(int handle) const;
+	unsigned int generation(int handle) const;
+
+	// Checks the sources for changes and finishes rebuilds that are ready,
+	// called once per frame
+	void update();
+
+private:
+
+	std::string cacheDir;
+	std::string driver;
+	bool binaryCache;
+	bool parallelCompile;
+
+	std::vector<ShaderProgram> programs;
+	double lastPoll;
+
+	uint64_t source_key(const std::string& vertexCode, const std::string& fragmentCode) const;
+	std::string cache_path(uint64_t key) const;
+	unsigned int load_binary(uint64_t key) const;
+	void save_binary(unsigned int program, uint64_t key) const;
+
+	bool read_sources(ShaderProgram& shader, std::string& vertexCode, std::string& fragmentCode);
+	unsigned int start_build(const std::string& vertexCode, const std::string& fragmentCode) const;
+	bool is_built(unsigned int program) const;
+	bool finish_build(unsigned int program, const char* name) const;
+	void swap(ShaderProgram& shader, unsigned int program);
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <cube.hpp>
+#include <timestep.hpp>
+#include <spsc_queue.hpp>
+#include <triple_buffer.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define COMMAND_QUEUE_SIZE 256
+
+enum SimCommandType { moveCommand, scrambleCommand, resetCommand, tickRateCommand, loadCommand,
+	solveCommand, finishCommand, turnDurationCommand };
+
+// value holds the size for resets and loads, the tick rate, the turn duration in
+// milliseconds, or the input id of a move.
+// A load carries its facelets on the heap, the simulation frees them.
+struct SimCommand {
+	SimCommandType type;
+	RotationParams params;
+	int value;
+	uint8_t* facelets = nullptr;
+};
+
+// Runs the cube logic on its own thread at a fixed tick rate. The render thread
+// sends commands through a lock-free queue and reads back the latest published
+// CubeSnapshot, so it never waits on the simulation. While the cube rests with
+// no command pending, the thread sleeps until the next command arrives.
+class Simulation
+{
+public:
+
+	Simulation(unsigned int size = DEFAULT_SIZE);
+	~Simulation();
+
+	void start();
+	void stop();
+
+	// Render thread API
+	void rotate_face(int faceIndex, bool contrary, RotateDirection dir, unsigned int inputId = 0);
+	void scramble();
+	void reset(unsigned int size);
+	void load(unsigned int size, const uint8_t* facelets);
+	void solve();
+	void finish();
+	void set_tick_rate(int tickRate);
+	void set_turn_duration(float duration);
+
+	const CubeSnapshot& get_snapshot();
+	float get_alpha(const CubeSnapshot& snapshot);
+
+private:
+
+	Cube* cube;
+	unsigned int cubeId = 1;
+	FixedTimestep timestep;
+	int requestedTickRate = DEFAULT_TICK_RATE;
+	int requestedTurnDuration = (int)(DEFAULT_TURN_DURATION * 1000);
+	float turnDuration = DEFAULT_TURN_DURATION;
+
+	std::thread thread;
+	std::atomic<bool> running = false;
+
+	SpscQueue<SimCommand, COMMAND_QUEUE_SIZE> commands;
+	TripleBuffer<CubeSnapshot> snapshots;
+
+	// Only guards the idle wait, commands themselves never take it
+	std::mutex wakeMutex;
+	std::condition_variable wake;
+
+	void run();
+	bool process_commands();
+	void load_facelets(SimCommand& command);
+	void publish(double tickTime);
+	void send(SimCommand command);
+	void wake_up();
+};
+
+#endif
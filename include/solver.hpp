@@ -0,0 +1,61 @@
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+
+#include <cube3.hpp>
+#include <pdb.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+#define SOLVER_MAX_DEPTH 30
+#define SOLVER_SPLIT_DEPTH 3
+
+// Optimal 3x3 solver: IDA* over Cube3 with the max of a corner pattern database
+// and one edge pattern database read twice, once directly and once through the
+// symmetry that maps the other edges onto the tracked ones. Successors never
+// turn the same face twice and take opposite faces in one order only. The first
+// SOLVER_SPLIT_DEPTH levels are expanded up front, symmetric duplicates among
+// them dropped, and the rest of the tree is searched in parallel.
+class Solver
+{
+public:
+
+	Solver(const PatternDatabase& corners, const PatternDatabase& edges);
+
+	// Returns the solution length, or -1 when none fits in maxLength. One solve
+	// runs at a time per Solver, get_nodes counts the last one.
+	int solve(const Cube3& cube, uint8_t* solution, int maxLength, unsigned int threads = 0);
+	int heuristic(const Cube3& cube) const;
+
+	uint64_t get_nodes() const { return nodes; }
+
+private:
+
+	struct Bounds {
+		int corners;
+		int edges;
+		int otherEdges;
+	};
+
+	struct Frontier {
+		Cube3 cube;
+		Bounds bounds;
+		uint8_t path[SOLVER_SPLIT_DEPTH];
+		int lastFace;
+	};
+
+	const PatternDatabase& corners;
+	const PatternDatabase& edges;
+	int edgeSymmetry = 0;
+
+	std::atomic<uint64_t> nodes = 0;
+	std::atomic<bool> found = false;
+
+	Bounds root_bounds(const Cube3& cube) const;
+	bool child_bounds(const Cube3& cube, const Bounds& parent, int limit, Bounds& bounds) const;
+	bool search(const Cube3& cube, const Bounds& bounds, int depth, int bound, int lastFace, uint8_t* path, uint64_t& count);
+};
+
+int allowedFaces(int lastFace);
+
+#endif
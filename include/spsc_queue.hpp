@@ -0,0 +1,61 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer / single-consumer ring buffer. push() must only be
+// called from one thread and pop() from one other thread. Capacity must be a
+// power of two; one slot is kept free to tell a full queue from an empty one.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+
+	bool push(const T& item)
+	{
+		size_t tail = writeIndex.load(std::memory_order_relaxed);
+		size_t next = (tail + 1) & (Capacity - 1);
+
+		if (next == readIndex.load(std::memory_order_acquire))
+			return false;
+
+		items[tail] = item;
+		writeIndex.store(next, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(T& item)
+	{
+		size_t head = readIndex.load(std::memory_order_relaxed);
+
+		if (head == writeIndex.load(std::memory_order_acquire))
+			return false;
+
+		item = items[head];
+		readIndex.store((head + 1) & (Capacity - 1), std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire);
+	}
+
+	size_t size() const
+	{
+		size_t head = readIndex.load(std::memory_order_acquire);
+		size_t tail = writeIndex.load(std::memory_order_acquire);
+		return (tail - head) & (Capacity - 1);
+	}
+
+private:
+
+	T items[Capacity];
+	alignas(64) std::atomic<size_t> writeIndex = 0;
+	alignas(64) std::atomic<size_t> readIndex = 0;
+};
+
+#endif
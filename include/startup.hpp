@@ -0,0 +1,47 @@
+#ifndef STARTUP_HPP
+#define STARTUP_HPP
+
+#include <string>
+#include <vector>
+
+#define STARTUP_TARGET_MS 100.0
+
+// One startup step, times in milliseconds. end is measured from the start of
+// the process, background steps also ran in parallel with the ones after them.
+struct StartupPhase {
+	std::string name;
+	double duration;
+	double end;
+	bool background;
+};
+
+// Times the steps from process start to the first presented frame, then the
+// lazy steps that finish afterwards. Render thread only.
+class StartupProfile
+{
+public:
+
+	StartupProfile();
+
+	// Ends the current step, which started where the previous one ended
+	void mark(const char* name);
+	// Records a step that ran on its own, lazily or on a worker thread
+	void add(const char* name, double durationMs);
+
+	// Marks the first presented frame and prints the steps so far
+	void first_frame();
+	bool has_first_frame() const;
+	double first_frame_ms() const;
+
+	const std::vector<StartupPhase>& get_phases() const;
+	void print(const StartupPhase& phase) const;
+
+private:
+
+	double startTime;
+	double lastTime;
+	double firstFrameMs = -1.0;
+	std::vector<StartupPhase> phases = {};
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef STICKER_FACES_HPP
+#define STICKER_FACES_HPP
+
+#include <cube.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#define STICKER_FACES 6
+
+// Sticker colors of a cube, face by face in the URFDLB facelet layout, kept in
+// step with snapshots by replaying their committed turns. A turn only touches
+// the stickers of its layer and records which rows and columns of which faces
+// changed, so the work and the uploads that follow scale with the move and not
+// with the cube. Anything that cannot be replayed rebuilds every face.
+class StickerFaces
+{
+public:
+
+	// Catches up with the snapshot, returns false if nothing changed
+	bool sync(const CubeSnapshot& snapshot);
+	void turn(int axis, int layer, bool positive);
+
+	unsigned int size() const { return n; }
+	const uint8_t* face(int face) const { return facelets.data() + face * n * n; }
+
+	bool face_dirty(int face) const { return dirtyFaces[face]; }
+	bool row_dirty(int face, unsigned int row) const { return dirtyRows[face * n + row]; }
+	bool col_dirty(int face, unsigned int col) const { return dirtyCols[face * n + col]; }
+	bool is_dirty() const { return dirty; }
+	void clear_dirty();
+
+private:
+
+	unsigned int n = 0;
+	unsigned int cubeId = 0;
+	unsigned int version = 0;
+
+	std::vector<uint8_t> facelets = {};
+	std::vector<uint8_t> dirtyRows = {};
+	std::vector<uint8_t> dirtyCols = {};
+	bool dirtyFaces[STICKER_FACES] = {};
+	bool dirty = false;
+
+	std::vector<int> moved = {};
+	std::vector<uint8_t> movedColors = {};
+
+	void rebuild(const CubeSnapshot& snapshot);
+	bool replay(const CubeSnapshot& snapshot);
+};
+
+#endif
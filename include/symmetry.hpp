@@ -0,0 +1,22 @@
+#ifndef SYMMETRY_HPP
+#define SYMMETRY_HPP
+
+#include <cube3.hpp>
+#include <cubie.hpp>
+
+#define SYMMETRY_COUNT 48
+
+// The 48 symmetries of the cube as cubie cubes, numbered 16 * urf3 + 8 * f2 +
+// 2 * u4 + lr2 from Kociemba's basic symmetries. Odd ones are mirrored, their
+// corner orientations are stored as 3..5.
+const CubieCube& symmetryCube(int symmetry);
+int inverseSymmetry(int symmetry);
+
+// S * cube * S^-1, which has the same distance to solved as cube
+Cube3 conjugate(const Cube3& cube, int symmetry);
+int conjugateMove(int symmetry, int move);
+
+// Smallest conjugate in byte order, equal for every symmetric variant of a state
+Cube3 canonicalState(const Cube3& cube);
+
+#endif
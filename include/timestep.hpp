@@ -0,0 +1,34 @@
+#ifndef TIMESTEP_HPP
+#define TIMESTEP_HPP
+
+#define DEFAULT_TICK_RATE 120
+#define MIN_TICK_RATE 30
+#define MAX_TICK_RATE 480
+#define MAX_FRAME_TIME 0.25
+
+// Accumulates real frame time and hands it out as a whole number of fixed
+// simulation ticks. The leftover fraction is exposed as alpha so the renderer
+// can interpolate between the previous and the current simulation state.
+class FixedTimestep
+{
+public:
+
+	FixedTimestep(int tickRate = DEFAULT_TICK_RATE);
+
+	int advance(double frameTime);
+	void set_tick_rate(int newTickRate);
+
+	float get_dt();
+	float get_alpha();
+	int get_tick_rate();
+
+private:
+
+	int tickRate;
+	double dt;
+	double accumulator = 0.0;
+};
+
+double simulationClock();
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer: the producer always owns a back buffer it can fill
+// without waiting, the consumer always owns a front buffer that stays unchanged
+// until it asks for a newer one. The third buffer is exchanged between them.
+template <typename T>
+class TripleBuffer
+{
+public:
+
+	// Producer side
+	T& write_buffer()
+	{
+		return buffers[backIndex];
+	}
+
+	void publish()
+	{
+		backIndex = middle.exchange(backIndex | DIRTY_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// Consumer side, returns the most recently published buffer
+	const T& read()
+	{
+		if (middle.load(std::memory_order_acquire) & DIRTY_BIT)
+			frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+
+		return buffers[frontIndex];
+	}
+
+	bool has_new_data() const
+	{
+		return middle.load(std::memory_order_acquire) & DIRTY_BIT;
+	}
+
+private:
+
+	static constexpr uint8_t DIRTY_BIT = 0x4;
+	static constexpr uint8_t INDEX_MASK = 0x3;
+
+	T buffers[3];
+	uint8_t backIndex = 0;
+	alignas(64) std::atomic<uint8_t> middle = 1;
+	alignas(64) uint8_t frontIndex = 2;
+};
+
+#endif
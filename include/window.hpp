@@ -7,8 +7,15 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
-#include <cube.hpp>
+#include <simulation.hpp>
+#include <scene.hpp>
 #include <settings.hpp>
+#include <timestep.hpp>
+#include <latency.hpp>
+#include <keymap.hpp>
+#include <camera.hpp>
+#include <startup.hpp>
+#include <frame_pacer.hpp>
 
 #include <iostream>
 #include <string>
@@ -18,6 +25,7 @@
 #define W_NAME "RubikGL"
 
 #define VIEW_ROTATION_SPEED 300.0f;
+#define CUBE_STATE_PATH "cube_state.txt"
 
 class Window
 {
@@ -26,9 +34,9 @@ public:
 	Window(int width = W_WIDTH, int height = W_HEIGHT, const std::string& name = W_NAME);
 	~Window();
 
-	bool init();
+	bool init(StartupProfile& startup);
 	void clear();
-	void update();
+	void update(const CubeSnapshot& snapshot);
 	bool should_close();
 
 	void init_imGui();
@@ -36,9 +44,14 @@ public:
 	void render_imGui();
 	void cleanup_imGui();
 
-	void draw_ui_frames(Cube*& _cube);
+	void draw_ui_frames(Simulation& _simulation, const CubeSnapshot& snapshot, const SceneSnapshot& scene);
+	void tick(GLfloat dt);
 
 	SETTINGS get_settings();
+	SETTINGS get_render_settings(float alpha);
+	const Camera& get_camera(float alpha);
+	void resize(int width, int height);
+	void keep_awake();
 	GLfloat deltaTime;
 
 private:
@@ -50,9 +63,16 @@ private:
 	GLFWwindow* window;
 	ImGuiIO* io;
 	SETTINGS settings;
+	Camera camera;
 	GLfloat lastFrame;
+	bool vsync = true;
 
-	Cube* cube;
+	FramePacer pacer;
+	LatencyTracker latency;
+	double keyEventTime = 0;
+
+	Simulation* simulation;
+	const StartupProfile* startup;
 
 	bool init_GLFW();
 	bool init_GLEW();
@@ -61,19 +81,30 @@ private:
 	float totalViewRotationAngle = 0;
 	float currentViewRotationAngle = 0;
 	float viewRotationSpeed = VIEW_ROTATION_SPEED;
+	float previousRotationAngle = 0;
+	float previousFlipAngle = 0;
 	std::string viewRotDirection = "";
 	bool keyDown = false;
 	bool shiftDown = false;
 
+	Keymap keymap;
+	int viewOrientation;
+
 	std::string lastMove = "";
+	std::string stateStatus = "";
 
 	void start_view_rotation(std::string direction);
-	void update_view_rotation();
+	void update_view_rotation(GLfloat dt);
 	void processInput(int key, int scancode, int action, int mods);
 
-	void draw_main_frame(Cube*& _cube);
+	void save_state(const CubeSnapshot& snapshot);
+	void load_state();
+
+	void draw_main_frame(const CubeSnapshot& snapshot, const SceneSnapshot& scene);
 	void draw_controls_frame();
-	void draw_cube_infos_frame(Cube*& _cube);
+	void draw_cube_infos_frame(const CubeSnapshot& snapshot);
+	void draw_latency_frame();
+	void draw_startup_table();
 
 	static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 };
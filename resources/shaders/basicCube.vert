@@ -1,17 +1,60 @@
 #version 330 core
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec2 aTexCoord;
+layout(location = 2) in vec2 aHiddenTexCoord;
+layout(location = 3) in float aFace;
+layout(location = 4) in uint aFaceMask;
+layout(location = 5) in float aPosX;
+layout(location = 6) in float aPosY;
+layout(location = 7) in float aPosZ;
+layout(location = 8) in uint aRotation;
+
+#define MAX_PARALLEL_SLICES 16
 
 out vec3 Pos;
 out vec2 TexCoord;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+uniform mat3 rotations[24];
+uniform float cubeScale;
+uniform float layerOffset;
+
+// Slices turning about sliceAxis, each given by its layer and current angle
+uniform int sliceAxis;
+uniform int sliceCount;
+uniform int sliceLayers[MAX_PARALLEL_SLICES];
+uniform float sliceAngles[MAX_PARALLEL_SLICES];
+
+// When the faces are drawn as textures, only pieces on and next to turning slices are kept
+uniform int lodCull;
+
 void main() 
 {
+    vec3 piecePos = vec3(aPosX, aPosY, aPosZ);
+    vec3 world = rotations[aRotation] * aPos + piecePos;
+
+    int layer = int(round(piecePos[sliceAxis] + layerOffset));
+    int u = (sliceAxis + 1) % 3, v = (sliceAxis + 2) % 3;
+
+    bool nearSlice = false;
+    for (int i = 0; i < sliceCount; i++)
+    {
+        nearSlice = nearSlice || abs(sliceLayers[i] - layer) <= 1;
+        if (sliceLayers[i] != layer) continue;
+
+        float c = cos(sliceAngles[i]), s = sin(sliceAngles[i]);
+        float wu = world[u], wv = world[v];
+        world[u] = c * wu - s * wv;
+        world[v] = s * wu + c * wv;
+    }
+
     Pos = aPos;
-    TexCoord = aTexCoord;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    TexCoord = ((aFaceMask >> uint(aFace)) & 1u) != 0u ? aTexCoord : aHiddenTexCoord;
+    gl_Position = projection * view * vec4(world * cubeScale, 1.0);
+
+    // Outside the clip volume, the whole piece is culled before rasterization
+    if (lodCull != 0 && !nearSlice)
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
 }
\ No newline at end of file
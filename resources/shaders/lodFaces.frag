@@ -0,0 +1,36 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 PiecePos;
+in vec2 Sticker;
+flat in int Face;
+
+#define MAX_PARALLEL_SLICES 16
+
+uniform usampler2DArray facelets;
+uniform sampler2D texture1;
+uniform vec2 stickerOrigins[6];
+uniform vec2 stickerSize;
+uniform float cubeSize;
+
+// Pieces on and next to turning slices are drawn as geometry instead
+uniform int sliceAxis;
+uniform int sliceCount;
+uniform int sliceLayers[MAX_PARALLEL_SLICES];
+
+void main()
+{
+    int n = int(cubeSize);
+    int layer = clamp(int(floor(PiecePos[sliceAxis] + cubeSize * 0.5)), 0, n - 1);
+    for (int i = 0; i < sliceCount; i++)
+    {
+        if (abs(sliceLayers[i] - layer) <= 1) discard;
+    }
+
+    // Each sticker samples the same part of the texture as a full piece would,
+    // with gradients of the whole face so mip selection has no seams
+    ivec2 texel = clamp(ivec2(floor(Sticker)), ivec2(0), ivec2(n - 1));
+    uint color = texelFetch(facelets, ivec3(texel, Face), 0).r;
+    vec2 uv = stickerOrigins[color] + fract(Sticker) * stickerSize;
+    FragColor = textureGrad(texture1, uv, dFdx(Sticker) * stickerSize, dFdy(Sticker) * stickerSize);
+}
\ No newline at end of file
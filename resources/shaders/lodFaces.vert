@@ -0,0 +1,36 @@
+#version 330 core
+
+// One quad per face, the vertices come from gl_VertexID alone
+out vec3 PiecePos;
+out vec2 Sticker;
+flat out int Face;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float cubeScale;
+uniform float cubeSize;
+
+const vec2 corners[6] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+                               vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0));
+
+// Point at (column, row) of a face in URFDLB order, the same layout as the facelet string
+vec3 facePoint(int face, vec2 sticker)
+{
+    float n = cubeSize;
+    float c = 2.0 * sticker.x, r = 2.0 * sticker.y;
+
+    if (face == 0) return vec3(-n + c, n, -n + r);
+    if (face == 1) return vec3(n, n - r, n - c);
+    if (face == 2) return vec3(-n + c, n - r, n);
+    if (face == 3) return vec3(-n + c, -n, n - r);
+    if (face == 4) return vec3(-n, n - r, -n + c);
+    return vec3(n - c, n - r, -n);
+}
+
+void main()
+{
+    Face = gl_VertexID / 6;
+    Sticker = corners[gl_VertexID % 6] * cubeSize;
+    PiecePos = facePoint(Face, Sticker) * 0.5;
+    gl_Position = projection * view * vec4(PiecePos * cubeScale, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aTexCoord;
+layout(location = 2) in vec2 aHiddenTexCoord;
+layout(location = 3) in float aFace;
+layout(location = 4) in uint aFaceMask;
+layout(location = 5) in float aPosX;
+layout(location = 6) in float aPosY;
+layout(location = 7) in float aPosZ;
+layout(location = 8) in uint aRotation;
+
+// Per cube rather than per piece: where the cube sits, its slice axis in w,
+// and the current angle of each of its layers along that axis
+layout(location = 9) in vec4 aCube;
+layout(location = 10) in vec4 aLayerAngles0;
+layout(location = 11) in vec4 aLayerAngles1;
+
+#define SCENE_MAX_SIZE 8
+
+out vec3 Pos;
+out vec2 TexCoord;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform mat3 rotations[24];
+uniform float cubeScale;
+uniform float layerOffset;
+
+void main()
+{
+    vec3 piecePos = vec3(aPosX, aPosY, aPosZ);
+    vec3 world = rotations[aRotation] * aPos + piecePos;
+
+    int sliceAxis = int(aCube.w);
+    int layer = clamp(int(round(piecePos[sliceAxis] + layerOffset)), 0, SCENE_MAX_SIZE - 1);
+    float angle = layer < 4 ? aLayerAngles0[layer] : aLayerAngles1[layer - 4];
+
+    if (angle != 0.0)
+    {
+        int u = (sliceAxis + 1) % 3, v = (sliceAxis + 2) % 3;
+        float c = cos(angle), s = sin(angle);
+        float wu = world[u], wv = world[v];
+        world[u] = c * wu - s * wv;
+        world[v] = s * wu + c * wv;
+    }
+
+    Pos = aPos;
+    TexCoord = ((aFaceMask >> uint(aFace)) & 1u) != 0u ? aTexCoord : aHiddenTexCoord;
+    gl_Position = projection * view * vec4(world * cubeScale + aCube.xyz, 1.0);
+}
@@ -0,0 +1,630 @@
+#include <cube.hpp>
+#include <cube3.hpp>
+#include <facelet_cube.hpp>
+#include <cubie.hpp>
+#include <cube_io.hpp>
+#include <sticker_faces.hpp>
+#include <scene.hpp>
+#include <timestep.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <new>
+#include <cstdlib>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#define BENCH_SEED 1234
+#define BENCH_SCENE_CUBES 1000
+#define BENCH_SCENE_SECONDS 1.0
+#define BENCH_LONG_RUN_MOVES 20000
+
+// Every heap allocation of the benchmark is counted, to see what a cube costs to build.
+// The scene allocates from its worker threads too.
+static std::atomic<size_t> allocationCount = 0;
+
+void* operator new(size_t bytes)
+{
+	allocationCount++;
+	if (void* block = std::malloc(bytes ? bytes : 1))
+		return block;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept
+{
+	std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+	std::free(block);
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment)
+{
+	allocationCount++;
+	size_t align = (size_t)alignment;
+#ifdef _WIN32
+	if (void* block = _aligned_malloc(bytes ? bytes : 1, align))
+		return block;
+#else
+	if (void* block = std::aligned_alloc(align, (bytes + align - 1) / align * align))
+		return block;
+#endif
+	throw std::bad_alloc();
+}
+
+void operator delete(void* block, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+	_aligned_free(block);
+#else
+	std::free(block);
+#endif
+}
+
+void operator delete(void* block, size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(block, alignment);
+}
+
+static std::vector<RotationParams> random_moves(unsigned int size, unsigned int moveCount)
+{
+	std::mt19937 gen(BENCH_SEED);
+	std::uniform_int_distribution<> faceIndexDist(0, size - 1);
+	std::uniform_int_distribution<> boolDist(0, 1);
+	std::uniform_int_distribution<> dirDist(0, 2);
+
+	std::vector<RotationParams> moves(moveCount);
+	RotateDirection dirs[3] = { col, line, face };
+	for (RotationParams& move : moves)
+		move = { faceIndexDist(gen), boolDist(gen) == 0, dirs[dirDist(gen)] };
+
+	return moves;
+}
+
+// Moves per second of the generic NxN engine, applying instant quarter turns
+static double bench_generic(unsigned int size, unsigned int moveCount)
+{
+	Cube cube(size);
+	std::vector<RotationParams> moves = random_moves(size, moveCount);
+
+	double start = simulationClock();
+	for (RotationParams& move : moves)
+		cube.apply_move(move);
+	double elapsed = simulationClock() - start;
+
+	return moveCount / elapsed;
+}
+
+// Microseconds to build, scramble and tear down a cube, and the heap
+// allocations one such lifetime makes
+static double bench_lifetime(unsigned int size, unsigned int cubeCount, size_t& allocations)
+{
+	std::vector<RotationParams> moves = random_moves(size, 20);
+
+	size_t before = allocationCount;
+	double start = simulationClock();
+	for (unsigned int i = 0; i < cubeCount; i++)
+	{
+		Cube* cube = new Cube(size);
+		for (RotationParams& move : moves)
+			cube->rotate_face(move.faceIndex, move.contrary, move.dir);
+		cube->finish();
+		delete cube;
+	}
+	double elapsed = simulationClock() - start;
+	allocations = (allocationCount - before) / cubeCount;
+
+	return elapsed * 1e6 / cubeCount;
+}
+
+// Turns a cube far past CUBE_HISTORY_LIMIT. Once built it must not allocate
+// again, its history is dropped instead of growing in the arena.
+static bool check_long_run()
+{
+	std::vector<RotationParams> moves = random_moves(3, BENCH_LONG_RUN_MOVES);
+	Cube cube(3);
+	cube.set_turn_duration(MIN_TURN_DURATION);
+
+	size_t before = allocationCount;
+	for (RotationParams& move : moves)
+	{
+		cube.rotate_face(move.faceIndex, move.contrary, move.dir);
+		while (cube.is_rotating())
+			cube.update(MIN_TURN_DURATION);
+	}
+	size_t allocations = allocationCount - before;
+
+	CubeSnapshot snapshot;
+	cube.fill_snapshot(snapshot);
+	return allocations == 0 && !snapshot.historyComplete && snapshot.historyMoves == 0;
+}
+
+// Moves per second of the packed 3x3 engine
+static double bench_cube3(unsigned int moveCount, unsigned int& checksum)
+{
+	std::mt19937 gen(BENCH_SEED);
+	std::uniform_int_distribution<> moveDist(0, CUBE3_MOVES - 1);
+
+	std::vector<uint8_t> moves(moveCount);
+	for (uint8_t& move : moves)
+		move = moveDist(gen);
+
+	Cube3 cube;
+	double start = simulationClock();
+	for (uint8_t move : moves)
+		cube.apply(move);
+	double elapsed = simulationClock() - start;
+
+	// Keeps the loop from being optimized away
+	checksum = cube.corners[0] + cube.edges[0];
+
+	return moveCount / elapsed;
+}
+
+// Moves per second of the size-specialized facelet engine
+static double bench_facelets(unsigned int size, unsigned int moveCount)
+{
+	std::unique_ptr<FaceletEngine> engine = makeFaceletEngine(size);
+
+	std::vector<SliceMove> moves;
+	for (RotationParams& params : random_moves(size, moveCount))
+		moves.push_back(toSliceMove(params));
+
+	double start = simulationClock();
+	engine->apply(moves.data(), moves.size());
+	double elapsed = simulationClock() - start;
+
+	return moveCount / elapsed;
+}
+
+// The facelet engines must agree sticker for sticker with the piece model
+static bool check_facelets()
+{
+	for (unsigned int size = 2; size <= MAX_TEMPLATE_SIZE + 2; size++)
+	{
+		Cube cube(size);
+		std::unique_ptr<FaceletEngine> engine = makeFaceletEngine(size);
+
+		for (RotationParams& params : random_moves(size, 200))
+		{
+			SliceMove move = toSliceMove(params);
+			cube.apply_move(params);
+			engine->apply(&move, 1);
+		}
+
+		std::vector<uint8_t> facelets(6 * size * size);
+		cube.get_facelets(facelets.data());
+
+		for (size_t i = 0; i < facelets.size(); i++)
+		{
+			if (facelets[i] != engine->facelets()[i])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// Replayed sticker faces must match the pieces, with every change inside a dirty row, column or face
+static bool check_sticker_faces()
+{
+	std::mt19937 gen(BENCH_SEED);
+	unsigned int sizes[] = { 2, 3, 4, 5, 8, 13 };
+
+	for (unsigned int size : sizes)
+	{
+		Cube cube(size);
+		CubeSnapshot snapshot;
+		StickerFaces faces;
+		cube.fill_snapshot(snapshot);
+		faces.sync(snapshot);
+
+		std::vector<uint8_t> expected(6 * size * size), previous(6 * size * size);
+		for (int batch = 0; batch < 50; batch++)
+		{
+			for (int face = 0; face < STICKER_FACES; face++)
+				std::copy(faces.face(face), faces.face(face) + size * size, previous.begin() + face * size * size);
+			faces.clear_dirty();
+
+			// Every tenth batch overflows the turn log and forces a rebuild
+			unsigned int moveCount = batch % 10 == 9 ? TURN_LOG_SIZE + 10 : 1 + gen() % 8;
+			for (RotationParams& params : random_moves(size, moveCount))
+				cube.apply_move(params);
+
+			cube.fill_snapshot(snapshot);
+			faces.sync(snapshot);
+			snapshotFacelets(snapshot, expected.data());
+
+			for (size_t i = 0; i < expected.size(); i++)
+			{
+				int face = (int)(i / (size * size)), row = (int)(i % (size * size)) / size, col = (int)(i % size);
+				if (faces.face(face)[row * size + col] != expected[i]) return false;
+
+				bool covered = faces.face_dirty(face) || faces.row_dirty(face, row) || faces.col_dirty(face, col);
+				if (expected[i] != previous[i] && !covered) return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// Replaying one turn against rebuilding every face from the pieces
+static void bench_sticker_faces(unsigned int size, unsigned int moveCount, double& replayUs, double& rebuildUs)
+{
+	Cube cube(size);
+	CubeSnapshot snapshot;
+	StickerFaces faces;
+	cube.fill_snapshot(snapshot);
+	faces.sync(snapshot);
+
+	std::vector<RotationParams> moves = random_moves(size, moveCount);
+	double replayTime = 0;
+	for (RotationParams& params : moves)
+	{
+		cube.apply_move(params);
+		cube.fill_snapshot(snapshot);
+
+		double start = simulationClock();
+		faces.sync(snapshot);
+		replayTime += simulationClock() - start;
+		faces.clear_dirty();
+	}
+
+	std::vector<uint8_t> facelets(6 * size * size);
+	double start = simulationClock();
+	for (unsigned int i = 0; i < moveCount; i++)
+		snapshotFacelets(snapshot, facelets.data());
+	double rebuildTime = simulationClock() - start;
+
+	replayUs = replayTime / moveCount * 1e6;
+	rebuildUs = rebuildTime / moveCount * 1e6;
+}
+
+// Runs a scene of 3x3s in real time. Every published snapshot must hold the same
+// pieces in the shared block as in each cube, and every cube a valid coloring.
+static bool check_scene()
+{
+	Scene scene;
+	scene.set_layout(BENCH_SCENE_CUBES / 10, 3);
+	scene.start();
+
+	unsigned int checked = 0;
+	double end = simulationClock() + BENCH_SCENE_SECONDS / 2;
+	std::vector<uint8_t> facelets(6 * 3 * 3);
+	while (simulationClock() < end)
+	{
+		const SceneSnapshot& snapshot = scene.get_snapshot();
+		for (size_t c = 0; c < snapshot.cubes.size(); c++)
+		{
+			const PieceTransforms& pieces = snapshot.cubes[c].pieces;
+			for (size_t i = 0; i < pieces.size(); i++)
+			{
+				size_t shared = c * snapshot.piecesPerCube + i;
+				if (snapshot.pieces.get_pos(shared) != pieces.get_pos(i) || snapshot.pieces.get_rotation(shared) != pieces.get_rotation(i))
+					return false;
+			}
+
+			snapshotFacelets(snapshot.cubes[c], facelets.data());
+			int counts[6] = {};
+			for (uint8_t color : facelets)
+				counts[color]++;
+			for (int color = 0; color < 6; color++)
+			{
+				if (counts[color] != 9) return false;
+			}
+		}
+
+		if (!snapshot.cubes.empty())
+			checked++;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	// The cubes must have been turning all along, without keeping a history
+	const SceneSnapshot& last = scene.get_snapshot();
+	unsigned int moves = 0;
+	for (const CubeSnapshot& cube : last.cubes)
+	{
+		if (cube.historyComplete || cube.historyMoves != 0) return false;
+		moves += cube.numberOfMoves;
+	}
+
+	scene.stop();
+	return checked > 0 && last.cubes.size() == BENCH_SCENE_CUBES / 10 && moves > last.cubes.size();
+}
+
+// Average wall time of one scene tick, cube updates and snapshot copies included
+static double bench_scene(unsigned int threads, unsigned int cubeCount, unsigned int& threadsUsed)
+{
+	Scene scene(threads);
+	scene.set_layout(cubeCount, 3);
+	scene.start();
+
+	double total = 0, lastTick = 0;
+	unsigned int ticks = 0;
+	double end = simulationClock() + BENCH_SCENE_SECONDS;
+	while (simulationClock() < end)
+	{
+		const SceneSnapshot& snapshot = scene.get_snapshot();
+		if (snapshot.tickTime != lastTick && !snapshot.cubes.empty())
+		{
+			lastTick = snapshot.tickTime;
+			total += snapshot.updateMs;
+			threadsUsed = snapshot.threads;
+			ticks++;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	scene.stop();
+	return ticks > 0 ? total / ticks : 0.0;
+}
+
+// Cubie and facelet views of the same scramble must match, and round-trip
+static bool check_cubie()
+{
+	std::mt19937 gen(BENCH_SEED);
+	std::uniform_int_distribution<> moveDist(0, CUBE3_MOVES - 1);
+
+	for (int trial = 0; trial < 100; trial++)
+	{
+		Cube3 cube;
+		FaceletCube<3> facelets;
+
+		for (int i = 0; i < 30; i++)
+		{
+			int move = moveDist(gen);
+			cube.apply(move);
+			facelets.apply(faceTurn(move, 3));
+		}
+
+		uint8_t converted[FACELET_COUNT];
+		cubieToFacelets(toCubie(cube), converted);
+		for (int i = 0; i < FACELET_COUNT; i++)
+		{
+			if (converted[i] != facelets.facelets[i]) return false;
+		}
+
+		CubieCube cubie;
+		if (faceletsToCubie(facelets.facelets, cubie) != cubeValid) return false;
+		if (!(fromCubie(cubie) == cube) || validate(cube) != cubeValid) return false;
+
+		// Swapping two edges breaks parity, twisting one corner breaks the twist sum
+		std::swap(cubie.ep[0], cubie.ep[1]);
+		if (validate(cubie) != parityError) return false;
+		std::swap(cubie.ep[0], cubie.ep[1]);
+		cubie.co[0] = (cubie.co[0] + 1) % 3;
+		if (validate(cubie) != cornerTwist) return false;
+	}
+
+	return true;
+}
+
+// Nanoseconds per validate() call on scrambled states
+static double bench_validate(unsigned int stateCount)
+{
+	std::vector<Cube3> states(stateCount);
+	for (unsigned int i = 0; i < stateCount; i++)
+		states[i].scramble(25, BENCH_SEED + i);
+
+	unsigned int valid = 0;
+	double start = simulationClock();
+	for (Cube3& state : states)
+		valid += validate(state) == cubeValid;
+	double elapsed = simulationClock() - start;
+
+	if (valid != stateCount)
+		std::cerr << "Scrambled states reported invalid" << std::endl;
+
+	return elapsed * 1e9 / stateCount;
+}
+
+// Facelet strings, packed facelets and packed cubies round-trip, and loading
+// the facelets back into a fresh piece model reproduces them
+static bool check_io()
+{
+	for (unsigned int size = 2; size <= 7; size++)
+	{
+		Cube cube(size);
+		for (RotationParams& move : random_moves(size, 50))
+			cube.apply_move(move);
+
+		size_t count = faceletStringLength(size);
+		std::vector<uint8_t> facelets(count), decoded(count), bytes(packedFaceletBytes(size));
+		std::string text(count, ' ');
+		cube.get_facelets(facelets.data());
+
+		if (!writeFaceletString(facelets, text) || faceletStringSize(text) != size) return false;
+		if (!readFaceletString(text, decoded) || decoded != facelets) return false;
+
+		std::fill(decoded.begin(), decoded.end(), 0);
+		if (!packFacelets(facelets, bytes) || !unpackFacelets(bytes, decoded) || decoded != facelets) return false;
+
+		Cube loaded(size);
+		std::fill(decoded.begin(), decoded.end(), 0);
+		if (!loaded.set_facelets(facelets.data())) return false;
+		loaded.get_facelets(decoded.data());
+		if (decoded != facelets) return false;
+	}
+
+	for (int trial = 0; trial < 100; trial++)
+	{
+		Cube3 cube;
+		cube.scramble(25, BENCH_SEED + trial);
+
+		uint8_t bytes[CUBE3_PACKED_BYTES];
+		packCube3(cube, bytes);
+		if (!(unpackCube3(bytes) == cube)) return false;
+	}
+
+	return faceletStringSize("UUUURRRRFFFFDDDDLLLLBBBB") == 2 && faceletStringSize("UUU") == 0;
+}
+
+// Nanoseconds to parse and re-encode one 3x3 facelet string, no allocation in the loop
+static double bench_io(unsigned int stateCount)
+{
+	Cube3 cube;
+	cube.scramble(25, BENCH_SEED);
+	uint8_t facelets[FACELET_COUNT];
+	cubieToFacelets(toCubie(cube), facelets);
+
+	char text[FACELET_COUNT];
+	writeFaceletString(facelets, text);
+
+	unsigned int checksum = 0;
+	double start = simulationClock();
+	for (unsigned int i = 0; i < stateCount; i++)
+	{
+		readFaceletString(std::string_view(text, FACELET_COUNT), facelets);
+		writeFaceletString(facelets, text);
+		checksum += text[i % FACELET_COUNT];
+	}
+	double elapsed = simulationClock() - start;
+
+	if (checksum == 0)
+		std::cerr << "Facelet string checksum is zero" << std::endl;
+
+	return elapsed * 1e9 / stateCount;
+}
+
+static bool check_cube3()
+{
+	// Every face turn has order 4, (R U R' U') has order 6, (R U) has order 105
+	for (int move = 0; move < CUBE3_MOVES; move += 3)
+	{
+		Cube3 cube;
+		for (int i = 0; i < 4; i++) cube.apply(move);
+		if (!cube.is_solved()) return false;
+
+		cube.apply(move);
+		cube.apply(inverseMove(move));
+		if (!cube.is_solved()) return false;
+	}
+
+	Cube3 sexy;
+	for (int i = 0; i < 6; i++) sexy.apply("R U R' U'");
+	if (!sexy.is_solved()) return false;
+
+	Cube3 ru;
+	for (int i = 0; i < 104; i++)
+	{
+		ru.apply("R U");
+		if (ru.is_solved()) return false;
+	}
+	ru.apply("R U");
+
+	return ru.is_solved();
+}
+
+int main()
+{
+#ifdef CUBE3_SIMD
+	std::cout << "Cube3 kernels: SSSE3" << std::endl;
+#else
+	std::cout << "Cube3 kernels: scalar" << std::endl;
+#endif
+
+	if (!check_cube3())
+	{
+		std::cerr << "Cube3 move tables are inconsistent" << std::endl;
+		return 1;
+	}
+
+	if (!check_facelets())
+	{
+		std::cerr << "Facelet engine disagrees with the piece model" << std::endl;
+		return 1;
+	}
+
+	if (!check_sticker_faces())
+	{
+		std::cerr << "Replayed sticker faces disagree with the pieces" << std::endl;
+		return 1;
+	}
+
+	if (!check_long_run())
+	{
+		std::cerr << "A long running cube keeps allocating" << std::endl;
+		return 1;
+	}
+
+	if (!check_scene())
+	{
+		std::cerr << "Scene pieces disagree with its cubes" << std::endl;
+		return 1;
+	}
+
+	if (!check_cubie())
+	{
+		std::cerr << "Cubie model disagrees with the facelet engine" << std::endl;
+		return 1;
+	}
+
+	if (!check_io())
+	{
+		std::cerr << "State import/export does not round-trip" << std::endl;
+		return 1;
+	}
+
+	unsigned int checksum = 0;
+	double fast = bench_cube3(100000000, checksum);
+	std::cout << std::left << std::setw(20) << "Cube3 packed 3x3" << ": " << fast / 1e6 << " M moves/s (checksum " << checksum << ")" << std::endl;
+
+	std::cout << std::left << std::setw(20) << "Cubie validate" << ": " << bench_validate(1000000) << " ns/state" << std::endl;
+	std::cout << std::left << std::setw(20) << "Facelet string I/O" << ": " << bench_io(1000000) << " ns/state" << std::endl;
+
+	unsigned int sizes[] = { 2, 3, 4, 7, 10 };
+	for (unsigned int size : sizes)
+	{
+		double generic = bench_generic(size, 200000 / size);
+		std::string label = "Generic " + std::to_string(size) + "x" + std::to_string(size);
+		std::cout << std::left << std::setw(20) << label << ": " << generic / 1e6 << " M moves/s";
+		if (size == 3)
+			std::cout << " (packed 3x3 is " << fast / generic << "x faster)";
+		std::cout << std::endl;
+
+		double facelets = bench_facelets(size, 20000000 / (size * size));
+		label = "Facelets " + std::to_string(size) + "x" + std::to_string(size);
+		if (size > MAX_TEMPLATE_SIZE)
+			label += " (dyn)";
+		std::cout << std::left << std::setw(20) << label << ": " << facelets / 1e6 << " M moves/s" << std::endl;
+	}
+
+	unsigned int stickerSizes[] = { 10, 50, 100 };
+	for (unsigned int size : stickerSizes)
+	{
+		double replayUs, rebuildUs;
+		bench_sticker_faces(size, 2000, replayUs, rebuildUs);
+		std::string label = "Stickers " + std::to_string(size) + "x" + std::to_string(size);
+		std::cout << std::left << std::setw(20) << label << ": " << replayUs << " us/turn replayed, " << rebuildUs << " us rebuilt" << std::endl;
+	}
+
+	unsigned int threads = 0;
+	double parallel = bench_scene(0, BENCH_SCENE_CUBES, threads);
+	unsigned int single = 0;
+	double serial = bench_scene(1, BENCH_SCENE_CUBES, single);
+	std::string label = "Scene " + std::to_string(BENCH_SCENE_CUBES) + " 3x3s";
+	std::cout << std::left << std::setw(20) << label << ": " << parallel << " ms/tick on " << threads << " threads, "
+		<< serial << " ms on 1" << std::endl;
+
+	unsigned int lifetimeSizes[] = { 2, 3, 4, 7, 10, 20, 50 };
+	for (unsigned int size : lifetimeSizes)
+	{
+		size_t allocations = 0;
+		double lifetime = bench_lifetime(size, 200000 / (size * size), allocations);
+		std::string label = "Lifetime " + std::to_string(size) + "x" + std::to_string(size);
+		std::cout << std::left << std::setw(20) << label << ": " << lifetime << " us/cube, " << allocations << " allocations" << std::endl;
+	}
+
+	return 0;
+}
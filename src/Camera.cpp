@@ -0,0 +1,67 @@
+#include <camera.hpp>
+
+Camera::Camera(int width, int height)
+{
+	SETTINGS defaults;
+	rotationAngle = defaults.rotationAngle;
+	flipAngle = defaults.flipAngle;
+	zoom = defaults.zoom;
+	aspect = (width > 0 && height > 0) ? (float)width / (float)height : 1.0f;
+	viewportHeight = height > 0 ? height : 1;
+
+	build_view();
+	build_projection();
+}
+
+void Camera::update(const SETTINGS& settings)
+{
+	if (settings.rotationAngle == rotationAngle && settings.flipAngle == flipAngle && settings.zoom == zoom)
+		return;
+
+	rotationAngle = settings.rotationAngle;
+	flipAngle = settings.flipAngle;
+	zoom = settings.zoom;
+	build_view();
+}
+
+void Camera::set_viewport(int width, int height)
+{
+	// A minimized window reports a zero sized framebuffer, keep the last aspect
+	if (width <= 0 || height <= 0) return;
+	viewportHeight = height;
+
+	float newAspect = (float)width / (float)height;
+	if (newAspect == aspect) return;
+
+	aspect = newAspect;
+	build_projection();
+}
+
+const glm::mat4& Camera::get_view() const
+{
+	return view;
+}
+
+const glm::mat4& Camera::get_projection() const
+{
+	return projection;
+}
+
+int Camera::get_viewport_height() const
+{
+	return viewportHeight;
+}
+
+void Camera::build_view()
+{
+	float camX = sin(glm::radians(rotationAngle)) * zoom;
+	float camZ = cos(glm::radians(rotationAngle)) * zoom;
+
+	view = glm::lookAt(glm::vec3(camX, CAMERA_HEIGHT, camZ), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	view = glm::rotate(view, glm::radians(flipAngle), glm::vec3(1.0f, 0.0f, 0.0f));
+}
+
+void Camera::build_projection()
+{
+	projection = glm::perspective(glm::radians(CAMERA_FOV), aspect, CAMERA_NEAR, CAMERA_FAR);
+}
@@ -1,180 +1,240 @@
 #include <cube.hpp>
+#include <facelet_cube.hpp>
 
-Cube::Cube(unsigned int size) : size(size), shader(VSHADER_PATH, FSHADER_PATH)
+#include <atomic>
+
+static std::atomic<unsigned int> stateCounter = 0;
+
+Cube::Cube(unsigned int size, bool recordHistory)
+	: size(size), arena(cubeArenaBytes(size, recordHistory)), pieces(&arena), animations(&arena), moveQueue(&arena), history(&arena),
+	historyComplete(recordHistory), stateVersion(++stateCounter)
 {
 	float offset = (size - 1) / 2.0f;
+	pieces.reserve(cubePieceCount(size));
+	animations.reserve(size);
+	moveQueue.reserve(CUBE_QUEUE_RESERVE);
+	if (recordHistory)
+		history.reserve(CUBE_HISTORY_LIMIT);
 
-	for (int i = 0; i < size; i++)
+	for (unsigned int i = 0; i < size; i++)
 	{
-		for (int j = 0; j < size; j++)
+		for (unsigned int j = 0; j < size; j++)
 		{
-			for (int k = 0; k < size; k++)
-			{	
-				if (i != size - 1 && i != 0 && j != size - 1 && j != 0
-					&& k != size - 1 && k != 0)
-					continue;
-
-				float scale = 1.5f / size;
-				glm::vec3 pos = glm::vec3(i - offset, j - offset, k - offset);
-
-				Piece* piece = new Piece(pos, scale, size);
-				pieces.push_back(piece);
-			}
+			// Rows inside the cube only hold the two pieces on its surface
+			bool surface = i == 0 || i == size - 1 || j == 0 || j == size - 1;
+			unsigned int step = surface ? 1 : size - 1;
+
+			for (unsigned int k = 0; k < size; k += step)
+				pieces.add(glm::vec3(i - offset, j - offset, k - offset));
 		}
 	}
-	load_texture();
 }
 
-Cube::~Cube()
+void Cube::update(float deltaTime)
 {
-	for (Piece* piece : pieces)
+	for (SliceAnimation& animation : animations)
+		update_face_rotation(animation, deltaTime);
+
+	// Finished slices are committed and dropped, which may unblock the queue
+	for (size_t i = 0; i < animations.size();)
 	{
-		piece->cleanup();
-		delete piece;
+		SliceAnimation& animation = animations[i];
+		if ((animation.rotationSpeed >= 0 && animation.currentRotationAngle >= animation.totalRotationAngle) ||
+			(animation.rotationSpeed <= 0 && animation.currentRotationAngle <= animation.totalRotationAngle))
+		{
+			end_face_rotation(animation);
+			animations.erase(animations.begin() + i);
+		}
+		else i++;
 	}
-	pieces.clear();
+
+	start_queued_moves();
 }
 
-void Cube::draw(SETTINGS settings, GLfloat deltaTime)
+void Cube::rotate_face(int faceIndex, bool contrary, RotateDirection dir, unsigned int inputId)
 {
-	for (Piece* piece : pieces)
-	{
-		shader.use();
-		glUniform1i(glGetUniformLocation(shader.ID, "texture1"), 0);
-		piece->draw(shader, texture, settings.rotationAngle, settings.zoom, settings.flipAngle);
-	}
+	moveQueue.push_back({ { faceIndex, contrary, dir }, true, inputId, turnDuration });
+	inputBacklog++;
 
-	if (rotating) {
-		update_face_rotation(deltaTime);
-	}
+	start_queued_moves();
 }
 
-std::vector<Piece*> Cube::get_face_pieces(int faceIndex)
+bool Cube::is_rotating()
 {
-	std::vector<Piece*> facePieces;
-	float offset = (size - 1) / 2.0f;
+	return !animations.empty() || !moveQueue.empty();
+}
 
-	for (Piece* piece : pieces)
-	{
-		// cols rotation
-		if (piece->get_pos().x + offset == faceIndex && rotationDir == col)
-		{
-			facePieces.push_back(piece);
-		}
+bool Cube::can_start(RotationParams& params)
+{
+	if (animations.empty()) return true;
 
-		// lines rotation
-		if (piece->get_pos().y + offset == faceIndex && rotationDir == line)
-		{
-			facePieces.push_back(piece);
-		}
+	// The renderer animates at most MAX_PARALLEL_SLICES layers at once
+	if (animations.size() >= MAX_PARALLEL_SLICES) return false;
 
-		// faces rotation
-		if (piece->get_pos().z + offset == faceIndex && rotationDir == face)
-		{
-			facePieces.push_back(piece);
-		}
+	// Only slices parallel to the ones already turning commute with them
+	if (params.dir != animations[0].dir) return false;
+
+	for (SliceAnimation& animation : animations)
+	{
+		if (animation.faceIndex == params.faceIndex)
+			return false;
 	}
 
-	return facePieces;
+	return true;
 }
 
-void Cube::rotate_face(int faceIndex, bool contrary, RotateDirection dir)
+void Cube::start_queued_moves()
 {
-	if (rotating) return;
+	// Moves start in order, the head waits until it commutes with everything turning
+	while (!moveQueue.empty() && can_start(moveQueue.front().params))
+	{
+		QueuedMove move = moveQueue.front();
+		moveQueue.pop_front();
 
-	float angle = 90.0f, duration = 0.0f;
-	scrambling ? duration = SCRAMBLE_ROTATION_DURATION : duration = ROTATION_DURATION;
-	if (dir == face) angle *= -1;
-	if (!contrary) angle *= -1;
+		if (move.fromInput && inputBacklog > 0)
+			inputBacklog--;
 
-	rotatingFaceIndex = faceIndex;
-	rotationSpeed = angle / duration;
-	totalRotationAngle = angle;
-	rotationDir = dir;
+		start_face_rotation(move);
+	}
+}
 
-	rotatingFacePieces = get_face_pieces(faceIndex);
+void Cube::start_face_rotation(QueuedMove& move)
+{
+	float angle = moveAngle(move.params), duration = move.duration;
+
+	// Drain a backlog of key presses faster instead of letting input latency grow
+	if (move.fromInput)
+		duration /= glm::min(1.0f + inputBacklog * BACKLOG_SPEEDUP, MAX_BACKLOG_SPEEDUP);
+
+	SliceAnimation animation;
+	animation.faceIndex = move.params.faceIndex;
+	animation.dir = move.params.dir;
+	animation.totalRotationAngle = angle;
+	animation.currentRotationAngle = 0.0f;
+	animation.previousRotationAngle = 0.0f;
+	animation.rotationSpeed = angle / duration;
+	animation.inputId = move.inputId;
+	animation.startTime = move.inputId != 0 ? simulationClock() : 0.0;
+
+	animations.push_back(animation);
+	record_move(move.params);
+}
 
-	rotating = true;
-	currentRotationAngle = 0.0f;	
+void Cube::apply_move(RotationParams params)
+{
+	// Headless path: commit the quarter turn right away, no animation
+	SliceAnimation animation;
+	animation.faceIndex = params.faceIndex;
+	animation.dir = params.dir;
+	animation.totalRotationAngle = moveAngle(params);
+
+	end_face_rotation(animation);
+	record_move(params);
 }
 
-void Cube::load_texture()
+void Cube::record_move(RotationParams params)
 {
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
+	if (!historyComplete) return;
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// Slices on one axis commute, so the whole same-axis run at the end of the
+	// history is searched. An inverse cancels, a third quarter turn becomes one inverse.
+	int sameTurns[2] = { -1, -1 }, count = 0;
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	for (int i = (int)history.size() - 1; i >= 0 && history[i].dir == params.dir; i--)
+	{
+		if (history[i].faceIndex != params.faceIndex) continue;
 
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true);
+		if (history[i].contrary != params.contrary)
+		{
+			history.erase(history.begin() + i);
+			return;
+		}
+		if (count < 2) sameTurns[count++] = i;
+	}
 
-	unsigned char* data = stbi_load(TEXT_PATH, &width, &height, &nrChannels, 0);
-	if (data)
+	if (count == 2)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		history.erase(history.begin() + sameTurns[0]);
+		history.erase(history.begin() + sameTurns[1]);
+		params.contrary = !params.contrary;
 	}
-	else
+
+	// A longer history would leave its old storage stranded in the arena on every
+	// growth. Solving by undo is given up instead, the cube keeps turning.
+	if (history.size() == CUBE_HISTORY_LIMIT)
 	{
-		std::cout << "Failed to load texture" << std::endl;
+		history.clear();
+		historyComplete = false;
+		return;
 	}
-	stbi_image_free(data);
-}
-
-void Cube::update_face_rotation(GLfloat deltaTime) {
-	if (!rotating) return;
 
-	float angleStep = rotationSpeed * deltaTime;
-	currentRotationAngle += angleStep;
-
-	glm::vec3 rotVec;
-	if (rotationDir == line) rotVec = glm::vec3(0.0f, angleStep, 0.0f);
-	if (rotationDir == col) rotVec = glm::vec3(angleStep, 0.0f, 0.0f);
-	if (rotationDir == face) rotVec = glm::vec3(0.0f, 0.0f, angleStep);
+	history.push_back(params);
+}
 
-	// Stop condition
-	if ((angleStep >= 0 && currentRotationAngle >= totalRotationAngle) ||
-		(angleStep <= 0 && currentRotationAngle <= totalRotationAngle))
+void Cube::solve()
+{
+	if (!historyComplete) return;
+
+	// Undo the history and whatever is still queued, after the queue
+	std::vector<RotationParams> recorded(history.begin(), history.end());
+	for (QueuedMove& move : moveQueue)
+		record_move(move.params);
+
+	std::vector<RotationParams> solution(history.rbegin(), history.rend());
+	bool complete = historyComplete;
+	history.assign(recorded.begin(), recorded.end());
+	historyComplete = true;
+	if (!complete || solution.empty()) return;
+
+	// Long solutions are squeezed to play within SOLVE_PLAYBACK_TIME
+	float duration = glm::min(turnDuration, SOLVE_PLAYBACK_TIME / solution.size());
+	for (RotationParams& params : solution)
 	{
-		angleStep -= (currentRotationAngle - totalRotationAngle);
-		if (rotationDir == line) rotVec = glm::vec3(0.0f, angleStep, 0.0f);
-		if (rotationDir == col) rotVec = glm::vec3(angleStep, 0.0f, 0.0f);
-		if (rotationDir == face) rotVec = glm::vec3(0.0f, 0.0f, angleStep);
-		rotating = false;
+		params.contrary = !params.contrary;
+		moveQueue.push_back({ params, false, 0, duration });
+	}
 
-		for (Piece* piece : rotatingFacePieces)
-		{
-			if (size % 2 == 0)
-				piece->set_pos(roundToNearestHalf(piece->get_pos()));
-			else
-				piece->set_pos(round(piece->get_pos()));
+	start_queued_moves();
+}
 
-			piece->update_rotation(rotVec);
-		}
+void Cube::finish()
+{
+	// Commits turning slices and queued moves right away. The renderer only sees
+	// the next snapshot, so a whole solution costs one update whatever its length.
+	for (SliceAnimation& animation : animations)
+		end_face_rotation(animation);
+	animations.clear();
 
-		if (rotParams.empty())
-			scrambling = false;
+	while (!moveQueue.empty())
+	{
+		apply_move(moveQueue.front().params);
+		moveQueue.pop_front();
+	}
+	inputBacklog = 0;
+}
 
-		if (scrambling)
-		{
-			rotate_face(rotParams[0].faceIndex, rotParams[0].contrary, rotParams[0].dir);
-			rotParams.erase(rotParams.begin());
-			
-		}
+void Cube::set_turn_duration(float duration)
+{
+	turnDuration = glm::clamp(duration, MIN_TURN_DURATION, MAX_TURN_DURATION);
+}
 
-		return;
-	}
+void Cube::update_face_rotation(SliceAnimation& animation, float deltaTime) {
+	animation.previousRotationAngle = animation.currentRotationAngle;
+	animation.currentRotationAngle += animation.rotationSpeed * deltaTime;
+}
 
-	for (Piece* piece : rotatingFacePieces)
-	{
-		glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(angleStep), rotVec / angleStep);
-		piece->set_pos(glm::vec3(rotation * glm::vec4(piece->get_pos(), 1.0f)));
-		piece->update_rotation(rotVec);
-	}
+void Cube::end_face_rotation(SliceAnimation& animation)
+{
+	// Pieces stay at rest during the animation, the whole quarter turn is applied at once.
+	// The slice is found by position, so no piece list has to be kept per animation.
+	float layer = animation.faceIndex - (size - 1) / 2.0f;
+	int axis = rotationAxisIndex(animation.dir);
+	bool positive = animation.totalRotationAngle > 0;
+	pieces.turn_slice(axis, layer, positive);
+
+	unsigned int previousVersion = stateVersion;
+	stateVersion = ++stateCounter;
+	turnLog[turnCount++ % TURN_LOG_SIZE] = { previousVersion, stateVersion, axis, animation.faceIndex, positive };
 }
 
 void Cube::scramble()
@@ -186,9 +246,7 @@ void Cube::scramble()
 	std::uniform_int_distribution<> boolDist(0, 1);
 	std::uniform_int_distribution<> dirDist(0, 2);
 
-	scrambling = true;
-
-	for (int i = 0; i < 15 * (size - 1); i++) {
+	for (int i = 0; i < 15 * (int)(size - 1); i++) {
 		RotationParams r;
 
 		r.faceIndex = faceIndexDist(gen);
@@ -206,10 +264,226 @@ void Cube::scramble()
 			break;
 		}
 
-		rotParams.push_back(r);
+		moveQueue.push_back({ r, false, 0, turnDuration });
+	}
+
+	start_queued_moves();
+}
+
+void Cube::fill_snapshot(CubeSnapshot& snapshot)
+{
+	snapshot.size = size;
+	snapshot.numberOfMoves = numberOfMoves;
+	snapshot.queuedMoves = (unsigned int)moveQueue.size();
+	snapshot.historyMoves = (unsigned int)history.size();
+	snapshot.historyComplete = historyComplete;
+	snapshot.rotationDir = animations.empty() ? line : animations[0].dir;
+
+	// Resting pieces only change when a turn ends, most ticks copy nothing
+	if (snapshot.stateVersion != stateVersion)
+	{
+		snapshot.pieces = pieces;
+		snapshot.stateVersion = stateVersion;
+
+		size_t logged = glm::min(turnCount, (size_t)TURN_LOG_SIZE);
+		snapshot.turns.resize(logged);
+		for (size_t k = 0; k < logged; k++)
+			snapshot.turns[k] = turnLog[(turnCount - logged + k) % TURN_LOG_SIZE];
+	}
+
+	snapshot.animations.resize(animations.size());
+	for (size_t a = 0; a < animations.size(); a++)
+	{
+		snapshot.animations[a].faceIndex = animations[a].faceIndex;
+		snapshot.animations[a].previousRotationAngle = animations[a].previousRotationAngle;
+		snapshot.animations[a].currentRotationAngle = animations[a].currentRotationAngle;
+		snapshot.animations[a].inputId = animations[a].inputId;
+		snapshot.animations[a].startTime = animations[a].startTime;
+	}
+}
+
+static const glm::vec3 faceNormals[6] = {
+	glm::vec3(0, 1, 0), glm::vec3(1, 0, 0), glm::vec3(0, 0, 1),
+	glm::vec3(0, -1, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 0, -1)
+};
+
+void Cube::get_facelets(uint8_t* facelets)
+{
+	for (size_t i = 0; i < pieces.size(); i++)
+		pieceFacelets(size, pieces.get_home(i), pieces.get_pos(i), pieces.get_rotation(i), facelets);
+}
+
+bool Cube::set_facelets(const uint8_t* facelets)
+{
+	// Each slot takes an unused piece carrying the colors shown there, turned so
+	// its colored faces point where the facelets say. Pieces sharing the same
+	// colors look identical, so any of them will do.
+	float limit = (size - 1) / 2.0f;
+
+	std::vector<std::vector<int>> unused(64);
+	for (int i = (int)pieces.size() - 1; i >= 0; i--)
+	{
+		int mask = 0;
+		for (int color = 0; color < 6; color++)
+			if (glm::dot(pieces.get_home(i), faceNormals[color]) == limit) mask |= 1 << color;
+		unused[mask].push_back(i);
+	}
+
+	std::vector<glm::vec3> slots(pieces.size());
+	std::vector<uint8_t> orientations(pieces.size());
+	std::vector<int> assigned(pieces.size());
+
+	for (size_t slot = 0; slot < pieces.size(); slot++)
+	{
+		glm::vec3 pos = pieces.get_home(slot);
+		int faces[3], colors[3], count = 0, mask = 0;
+
+		for (int face = 0; face < 6; face++)
+		{
+			if (glm::dot(pos, faceNormals[face]) != limit) continue;
+
+			StickerPos p = { (int)round(pos.x * 2), (int)round(pos.y * 2), (int)round(pos.z * 2), face };
+			faces[count] = face;
+			colors[count] = facelets[stickerIndex(size, p)];
+			if (colors[count] > 5 || mask & 1 << colors[count]) return false;
+			mask |= 1 << colors[count];
+			count++;
+		}
+
+		if (unused[mask].empty()) return false;
+
+		int match = -1;
+		for (int r = 0; r < CUBE_ROTATIONS && match < 0; r++)
+		{
+			bool fits = true;
+			for (int k = 0; k < count && fits; k++)
+				fits = rotationMatrix(r) * faceNormals[colors[k]] == faceNormals[faces[k]];
+			if (fits) match = (int)r;
+		}
+		if (match < 0) return false;
+
+		assigned[slot] = unused[mask].back();
+		unused[mask].pop_back();
+		slots[slot] = pos;
+		orientations[slot] = (uint8_t)match;
+	}
+
+	for (size_t slot = 0; slot < pieces.size(); slot++)
+	{
+		pieces.set_pos(assigned[slot], slots[slot]);
+		pieces.set_rotation(assigned[slot], orientations[slot]);
+	}
+
+	animations.clear();
+	moveQueue.clear();
+
+	// The moves that led to the loaded state are unknown, there is nothing to undo
+	history.clear();
+	historyComplete = false;
+	stateVersion = ++stateCounter;
+	inputBacklog = 0;
+	numberOfMoves = 0;
+
+	return true;
+}
+
+size_t cubePieceCount(unsigned int size)
+{
+	size_t inner = size > 2 ? size - 2 : 0;
+	return (size_t)size * size * size - inner * inner * inner;
+}
+
+size_t cubeArenaBytes(unsigned int size, bool recordHistory)
+{
+	// Every reservation of the constructor, each with room to be realigned
+	return pieceBlockBytes(cubePieceCount(size))
+		+ size * sizeof(SliceAnimation) + alignof(SliceAnimation)
+		+ CUBE_QUEUE_RESERVE * sizeof(QueuedMove) + alignof(QueuedMove)
+		+ (recordHistory ? CUBE_HISTORY_LIMIT * sizeof(RotationParams) + alignof(RotationParams) : 0);
+}
+
+MoveQueue::MoveQueue(std::pmr::memory_resource* resource) : moves(resource)
+{
+}
+
+void MoveQueue::reserve(size_t count)
+{
+	moves.reserve(count);
+}
+
+void MoveQueue::push_back(const QueuedMove& move)
+{
+	moves.push_back(move);
+}
+
+void MoveQueue::pop_front()
+{
+	head++;
+
+	if (head == moves.size())
+		clear();
+	else if (head >= CUBE_QUEUE_RESERVE && head * 2 >= moves.size())
+	{
+		moves.erase(moves.begin(), moves.begin() + head);
+		head = 0;
+	}
+}
+
+QueuedMove& MoveQueue::front()
+{
+	return moves[head];
+}
+
+void MoveQueue::clear()
+{
+	moves.clear();
+	head = 0;
+}
+
+bool MoveQueue::empty() const
+{
+	return head == moves.size();
+}
+
+size_t MoveQueue::size() const
+{
+	return moves.size() - head;
+}
+
+QueuedMove* MoveQueue::begin()
+{
+	return moves.data() + head;
+}
+
+QueuedMove* MoveQueue::end()
+{
+	return moves.data() + moves.size();
+}
+
+void pieceFacelets(unsigned int size, glm::vec3 home, glm::vec3 pos, uint8_t rotation, uint8_t* facelets)
+{
+	// Each outer sticker keeps the color of the face its piece started on
+	float limit = (size - 1) / 2.0f;
+
+	for (int color = 0; color < 6; color++)
+	{
+		if (glm::dot(home, faceNormals[color]) != limit) continue;
+
+		glm::vec3 normal = rotationMatrix(rotation) * faceNormals[color];
+		int face = 0;
+		while (normal != faceNormals[face]) face++;
+
+		StickerPos p = { (int)round(pos.x * 2), (int)round(pos.y * 2), (int)round(pos.z * 2), face };
+		facelets[stickerIndex(size, p)] = (uint8_t)color;
 	}
+}
 
-	rotate_face(rotParams[0].faceIndex, rotParams[0].contrary, rotParams[0].dir);
+void snapshotFacelets(const CubeSnapshot& snapshot, uint8_t* facelets)
+{
+	// Slices still turning are read at their rest state, as if the turn had not started
+	const PieceTransforms& pieces = snapshot.pieces;
+	for (size_t i = 0; i < pieces.size(); i++)
+		pieceFacelets(snapshot.size, pieces.get_home(i), pieces.get_pos(i), pieces.get_rotation(i), facelets);
 }
 
 glm::vec3 roundToNearestHalf(glm::vec3 vec) {
@@ -218,4 +492,24 @@ glm::vec3 roundToNearestHalf(glm::vec3 vec) {
 	float z = round(vec.z * 2.0) / 2.0;
 
 	return glm::vec3(x, y, z);
+}
+
+float moveAngle(RotationParams params) {
+	float angle = 90.0f;
+	if (params.dir == face) angle *= -1;
+	if (!params.contrary) angle *= -1;
+
+	return angle;
+}
+
+glm::vec3 rotationAxis(RotateDirection dir) {
+	if (dir == line) return glm::vec3(0.0f, 1.0f, 0.0f);
+	if (dir == col) return glm::vec3(1.0f, 0.0f, 0.0f);
+	return glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+int rotationAxisIndex(RotateDirection dir) {
+	if (dir == col) return 0;
+	if (dir == line) return 1;
+	return 2;
 }
\ No newline at end of file
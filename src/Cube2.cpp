@@ -0,0 +1,347 @@
+#include <cube2.hpp>
+#include <symmetry.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#define CUBE2_TABLE_BYTES ((CUBE2_STATES + 3) / 4)
+
+// Corner slots that move, DBL (slot 6) stays put
+static const int movingSlots[7] = { URF, UFL, ULB, UBR, DFR, DLF, DRB };
+
+static int slotRank(int corner)
+{
+	return corner == DRB ? 6 : corner;
+}
+
+static uint32_t permIndex(const Cube3& cube)
+{
+	// Lehmer code of the 7 moving corners
+	uint32_t index = 0;
+	for (int i = 0; i < 7; i++)
+	{
+		int corner = slotRank(cube.corner_perm(movingSlots[i]));
+		int smaller = 0;
+		for (int j = i + 1; j < 7; j++)
+			smaller += slotRank(cube.corner_perm(movingSlots[j])) < corner;
+		index = index * (7 - i) + smaller;
+	}
+	return index;
+}
+
+static uint32_t twistIndex(const Cube3& cube)
+{
+	// The last twist follows from the others, the sum is always a multiple of 3
+	uint32_t index = 0;
+	for (int i = 0; i < 6; i++)
+		index = index * 3 + cube.corner_ori(movingSlots[i]);
+	return index;
+}
+
+static void setPerm(Cube3& cube, uint32_t index)
+{
+	int digits[7];
+	for (int i = 6; i >= 0; i--)
+	{
+		digits[i] = index % (7 - i);
+		index /= 7 - i;
+	}
+
+	// Digit i picks the digits[i]-th smallest corner not placed yet
+	bool used[7] = {};
+	for (int i = 0; i < 7; i++)
+	{
+		int rank = 0;
+		for (int skip = digits[i]; used[rank] || skip > 0; rank++)
+		{
+			if (!used[rank]) skip--;
+		}
+		used[rank] = true;
+
+		int corner = rank == 6 ? DRB : rank;
+		cube.corners[movingSlots[i]] = (uint8_t)(corner + 8 * cube.corner_ori(movingSlots[i]));
+	}
+}
+
+static void setTwist(Cube3& cube, uint32_t index)
+{
+	int sum = 0;
+	for (int i = 5; i >= 0; i--)
+	{
+		int twist = index % 3;
+		index /= 3;
+		sum += twist;
+		cube.corners[movingSlots[i]] = (uint8_t)(cube.corner_perm(movingSlots[i]) + 8 * twist);
+	}
+
+	int last = (3 - sum % 3) % 3;
+	cube.corners[movingSlots[6]] = (uint8_t)(cube.corner_perm(movingSlots[6]) + 8 * last);
+}
+
+// Twists move independently of which corner carries them, so two small
+// tables cover every move on the combined index
+struct Cube2MoveTables {
+	uint16_t perm[CUBE2_PERMS][CUBE2_MOVES];
+	uint16_t twist[CUBE2_TWISTS][CUBE2_MOVES];
+};
+
+static const Cube2MoveTables& moveTables()
+{
+	static const Cube2MoveTables* tables = [] {
+		Cube2MoveTables* t = new Cube2MoveTables;
+		for (uint32_t p = 0; p < CUBE2_PERMS; p++)
+		{
+			for (int move = 0; move < CUBE2_MOVES; move++)
+			{
+				Cube3 cube;
+				setPerm(cube, p);
+				cube.apply(move);
+				t->perm[p][move] = (uint16_t)permIndex(cube);
+			}
+		}
+		for (uint32_t w = 0; w < CUBE2_TWISTS; w++)
+		{
+			for (int move = 0; move < CUBE2_MOVES; move++)
+			{
+				Cube3 cube;
+				setTwist(cube, w);
+				cube.apply(move);
+				t->twist[w][move] = (uint16_t)twistIndex(cube);
+			}
+		}
+		return t;
+	}();
+
+	return *tables;
+}
+
+uint32_t cube2Index(const Cube3& cube)
+{
+	return permIndex(cube) * CUBE2_TWISTS + twistIndex(cube);
+}
+
+Cube3 cube2State(uint32_t index)
+{
+	Cube3 cube;
+	setPerm(cube, index / CUBE2_TWISTS);
+	setTwist(cube, index % CUBE2_TWISTS);
+	return cube;
+}
+
+uint32_t cube2Move(uint32_t index, int move)
+{
+	const Cube2MoveTables& tables = moveTables();
+	return tables.perm[index / CUBE2_TWISTS][move] * CUBE2_TWISTS + tables.twist[index % CUBE2_TWISTS][move];
+}
+
+bool Cube2Table::generate(unsigned int threads)
+{
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	const Cube2MoveTables& tables = moveTables();
+
+	file.close();
+	generated.assign(CUBE2_TABLE_BYTES, 0xFF);
+	header = {};
+	memcpy(header.magic, CUBE2_TABLE_MAGIC, sizeof(header.magic));
+	header.stateCount = CUBE2_STATES;
+
+	uint8_t* table = generated.data();
+	auto get = [&](uint32_t index) {
+		return (std::atomic_ref<uint8_t>(table[index >> 2]).load(std::memory_order_relaxed) >> ((index & 3) * 2)) & 3;
+	};
+
+	uint32_t solved = cube2Index(Cube3());
+	table[solved >> 2] &= (uint8_t)~(3 << ((solved & 3) * 2));
+	header.distribution[0] = 1;
+
+	uint32_t visited = 1;
+	for (int depth = 0; visited < CUBE2_STATES && depth + 1 < CUBE2_MAX_DEPTH; depth++)
+	{
+		int current = depth % 3, next = (depth + 1) % 3;
+
+		// Early levels expand the frontier forward. Once most states are visited it
+		// is cheaper to scan the unvisited ones for a neighbor on the current level.
+		// Either way a state only ever goes from unvisited to next, so concurrent
+		// fetch_and on a shared byte cannot undo another thread's mark.
+		bool backward = visited > CUBE2_STATES / 2;
+		std::atomic<uint32_t> found = 0;
+
+		auto worker = [&](uint32_t begin, uint32_t end) {
+			uint32_t count = 0;
+			for (uint32_t index = begin; index < end; index++)
+			{
+				int value = get(index);
+				uint32_t perm = index / CUBE2_TWISTS, twist = index % CUBE2_TWISTS;
+
+				if (backward)
+				{
+					if (value != CUBE2_UNVISITED) continue;
+					for (int move = 0; move < CUBE2_MOVES; move++)
+					{
+						uint32_t neighbor = tables.perm[perm][move] * CUBE2_TWISTS + tables.twist[twist][move];
+						if (get(neighbor) == current)
+						{
+							std::atomic_ref<uint8_t>(table[index >> 2]).fetch_and((uint8_t)~((3 - next) << ((index & 3) * 2)));
+							count++;
+							break;
+						}
+					}
+				}
+				else
+				{
+					// Residues repeat every 3 levels, older states only find visited neighbors
+					if (value != current) continue;
+					for (int move = 0; move < CUBE2_MOVES; move++)
+					{
+						uint32_t neighbor = tables.perm[perm][move] * CUBE2_TWISTS + tables.twist[twist][move];
+						if (get(neighbor) != CUBE2_UNVISITED) continue;
+
+						int shift = (neighbor & 3) * 2;
+						uint8_t before = std::atomic_ref<uint8_t>(table[neighbor >> 2]).fetch_and((uint8_t)~((3 - next) << shift));
+						if (((before >> shift) & 3) == CUBE2_UNVISITED) count++;
+					}
+				}
+			}
+			found += count;
+		};
+
+		uint32_t chunk = (CUBE2_STATES + threads - 1) / threads;
+		std::vector<std::thread> workers;
+		for (unsigned int i = 0; i < threads; i++)
+		{
+			uint32_t begin = i * chunk, end = begin + chunk < CUBE2_STATES ? begin + chunk : CUBE2_STATES;
+			if (begin < end)
+				workers.emplace_back(worker, begin, end);
+		}
+		for (std::thread& thread : workers)
+			thread.join();
+
+		if (found == 0) break;
+
+		header.distribution[depth + 1] = found;
+		header.maxDepth = depth + 1;
+		visited += found;
+	}
+
+	distances = table;
+	return visited == CUBE2_STATES;
+}
+
+bool Cube2Table::save(const char* path) const
+{
+	if (!distances) return false;
+
+	std::ofstream out(path, std::ios::binary);
+	if (!out)
+	{
+		std::cerr << "Failed to open " << path << " for writing" << std::endl;
+		return false;
+	}
+
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)distances, CUBE2_TABLE_BYTES);
+	return (bool)out;
+}
+
+bool Cube2Table::load(const char* path)
+{
+	// Mapped rather than read, only the pages a solve walks through are touched
+	generated.clear();
+	distances = nullptr;
+	if (!file.open_read(path))
+		return false;
+
+	if (file.size() == sizeof(header) + CUBE2_TABLE_BYTES)
+		memcpy(&header, file.data(), sizeof(header));
+
+	if (file.size() != sizeof(header) + CUBE2_TABLE_BYTES || memcmp(header.magic, CUBE2_TABLE_MAGIC, sizeof(header.magic)) != 0 ||
+		header.stateCount != CUBE2_STATES)
+	{
+		std::cerr << path << " is not a 2x2 distance table" << std::endl;
+		file.close();
+		return false;
+	}
+
+	distances = file.data() + sizeof(header);
+	return true;
+}
+
+int Cube2Table::next_move(uint32_t& index) const
+{
+	// The neighbor one level closer is the one whose residue is one less
+	int wanted = (residue(index) + 2) % 3;
+	for (int move = 0; move < CUBE2_MOVES; move++)
+	{
+		uint32_t neighbor = cube2Move(index, move);
+		if (residue(neighbor) == wanted)
+		{
+			index = neighbor;
+			return move;
+		}
+	}
+	return -1;
+}
+
+int Cube2Table::distance(uint32_t index) const
+{
+	uint32_t solved = cube2Index(Cube3());
+	int depth = 0;
+
+	while (index != solved)
+	{
+		if (next_move(index) < 0) return -1;
+		depth++;
+	}
+	return depth;
+}
+
+// Corners of cube * S, the whole cube turned by the rotation S once cube is reached
+static Cube3 rotateCorners(const Cube3& cube, const CubieCube& s)
+{
+	Cube3 result;
+	for (int i = 0; i < 8; i++)
+	{
+		int slot = s.cp[i];
+		result.corners[i] = (uint8_t)(cube.corner_perm(slot) + 8 * ((cube.corner_ori(slot) + s.co[i]) % 3));
+	}
+	return result;
+}
+
+int Cube2Table::solve(const Cube3& cube, uint8_t* solution, int maxLength) const
+{
+	if (!distances) return -1;
+
+	// A 2x2 has no centers, so it is only solved up to a whole cube rotation. Of the
+	// 24 rotations (the unmirrored symmetries), exactly one brings DBL home untwisted.
+	int rotation = -1;
+	Cube3 rotated;
+	for (int symmetry = 0; symmetry < SYMMETRY_COUNT && rotation < 0; symmetry += 2)
+	{
+		rotated = rotateCorners(cube, symmetryCube(symmetry));
+		if (rotated.corner_perm(DBL) == DBL && rotated.corner_ori(DBL) == 0)
+			rotation = symmetry;
+	}
+	if (rotation < 0) return -1;
+
+	uint32_t index = cube2Index(rotated);
+	uint32_t solved = cube2Index(Cube3());
+	int length = 0;
+
+	while (index != solved)
+	{
+		if (length == maxLength) return -1;
+
+		int move = next_move(index);
+		if (move < 0) return -1;
+
+		// cube * S * M is solved, so cube * (S M S^-1) is the rotation S^-1, and each
+		// move of the table is mapped back through S to the face it turns on cube
+		solution[length++] = (uint8_t)conjugateMove(rotation, move);
+	}
+	return length;
+}
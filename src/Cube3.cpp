@@ -0,0 +1,70 @@
+#include <cube3.hpp>
+
+#include <random>
+#include <sstream>
+
+static const char* moveNames[CUBE3_MOVES] = {
+	"U", "U2", "U'", "R", "R2", "R'", "F", "F2", "F'",
+	"D", "D2", "D'", "L", "L2", "L'", "B", "B2", "B'"
+};
+
+bool Cube3::apply(const std::string& sequence, std::string* rejected)
+{
+	std::istringstream stream(sequence);
+	std::string token;
+
+	while (stream >> token)
+	{
+		int move = parseMove(token);
+		if (move < 0)
+		{
+			if (rejected) *rejected = token;
+			return false;
+		}
+		apply(move);
+	}
+
+	return true;
+}
+
+void Cube3::scramble(unsigned int length, unsigned int seed)
+{
+	std::mt19937 gen(seed);
+	std::uniform_int_distribution<> moveDist(0, CUBE3_MOVES - 1);
+
+	int lastFace = -1;
+	for (unsigned int i = 0; i < length; i++)
+	{
+		int move = moveDist(gen);
+		if (move / 3 == lastFace)
+		{
+			i--;
+			continue;
+		}
+
+		apply(move);
+		lastFace = move / 3;
+	}
+}
+
+int inverseMove(int move)
+{
+	return move - move % 3 + (2 - move % 3);
+}
+
+const char* moveName(int move)
+{
+	if (move < 0 || move >= CUBE3_MOVES) return "?";
+	return moveNames[move];
+}
+
+int parseMove(const std::string& token)
+{
+	for (int i = 0; i < CUBE3_MOVES; i++)
+	{
+		if (token == moveNames[i])
+			return i;
+	}
+
+	return -1;
+}
@@ -0,0 +1,176 @@
+#include <cube_io.hpp>
+
+static const char faceletChars[] = FACELET_CHARS;
+
+// Letter to face index, 0xFF for anything that is not a face letter
+static constexpr auto faceletValues = [] {
+	struct { uint8_t values[256]; } table = {};
+	for (int c = 0; c < 256; c++) table.values[c] = 0xFF;
+	for (int face = 0; face < 6; face++) table.values[(unsigned char)FACELET_CHARS[face]] = (uint8_t)face;
+	return table;
+}();
+
+size_t faceletStringLength(unsigned int size)
+{
+	return 6 * (size_t)size * size;
+}
+
+unsigned int faceletStringSize(std::string_view text)
+{
+	// Returns the cube size the string describes, 0 if it is not 6*N*N long
+	if (text.size() % 6 != 0) return 0;
+
+	size_t perFace = text.size() / 6;
+	unsigned int size = 1;
+	while ((size_t)size * size < perFace) size++;
+
+	return (size_t)size * size == perFace ? size : 0;
+}
+
+bool writeFaceletString(std::span<const uint8_t> facelets, std::span<char> text)
+{
+	if (text.size() < facelets.size()) return false;
+
+	uint8_t highest = 0;
+	for (uint8_t facelet : facelets)
+		highest = facelet > highest ? facelet : highest;
+	if (highest > 5) return false;
+
+	for (size_t i = 0; i < facelets.size(); i++)
+		text[i] = faceletChars[facelets[i]];
+
+	return true;
+}
+
+bool readFaceletString(std::string_view text, std::span<uint8_t> facelets)
+{
+	if (text.size() != facelets.size()) return false;
+
+	uint8_t invalid = 0;
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		uint8_t value = faceletValues.values[(unsigned char)text[i]];
+		invalid |= value;
+		facelets[i] = value;
+	}
+
+	// Every valid value is below 8, so one check at the end covers the whole string
+	if (invalid & 0x80) return false;
+
+	return true;
+}
+
+size_t packedFaceletBytes(unsigned int size)
+{
+	return (faceletStringLength(size) * FACELET_BITS + 7) / 8;
+}
+
+bool packFacelets(std::span<const uint8_t> facelets, std::span<uint8_t> bytes)
+{
+	if (bytes.size() < (facelets.size() * FACELET_BITS + 7) / 8) return false;
+
+	uint32_t buffer = 0;
+	int bits = 0;
+	size_t out = 0;
+
+	for (uint8_t facelet : facelets)
+	{
+		if (facelet > 5) return false;
+
+		buffer |= (uint32_t)facelet << bits;
+		bits += FACELET_BITS;
+
+		while (bits >= 8)
+		{
+			bytes[out++] = (uint8_t)buffer;
+			buffer >>= 8;
+			bits -= 8;
+		}
+	}
+
+	if (bits > 0)
+		bytes[out] = (uint8_t)buffer;
+
+	return true;
+}
+
+bool unpackFacelets(std::span<const uint8_t> bytes, std::span<uint8_t> facelets)
+{
+	if (bytes.size() < (facelets.size() * FACELET_BITS + 7) / 8) return false;
+
+	uint32_t buffer = 0;
+	int bits = 0;
+	size_t in = 0;
+
+	for (uint8_t& facelet : facelets)
+	{
+		if (bits < FACELET_BITS)
+		{
+			buffer |= (uint32_t)bytes[in++] << bits;
+			bits += 8;
+		}
+
+		facelet = buffer & 0x7;
+		buffer >>= FACELET_BITS;
+		bits -= FACELET_BITS;
+
+		if (facelet > 5) return false;
+	}
+
+	return true;
+}
+
+void packCube3(const Cube3& cube, std::span<uint8_t, CUBE3_PACKED_BYTES> bytes)
+{
+	uint64_t buffer = 0;
+	int bits = 0;
+	size_t out = 0;
+
+	auto push = [&](uint32_t value) {
+		buffer |= (uint64_t)value << bits;
+		bits += 5;
+		while (bits >= 8)
+		{
+			bytes[out++] = (uint8_t)buffer;
+			buffer >>= 8;
+			bits -= 8;
+		}
+	};
+
+	for (int i = 0; i < 8; i++)
+		push(cube.corner_perm(i) | cube.corner_ori(i) << 3);
+	for (int i = 0; i < 12; i++)
+		push(cube.edge_perm(i) | cube.edge_ori(i) << 4);
+
+	bytes[out] = (uint8_t)buffer;
+}
+
+Cube3 unpackCube3(std::span<const uint8_t, CUBE3_PACKED_BYTES> bytes)
+{
+	Cube3 cube;
+	uint64_t buffer = 0;
+	int bits = 0;
+	size_t in = 0;
+
+	auto pull = [&]() {
+		if (bits < 5)
+		{
+			buffer |= (uint64_t)bytes[in++] << bits;
+			bits += 8;
+		}
+		uint32_t value = buffer & 0x1F;
+		buffer >>= 5;
+		bits -= 5;
+		return value;
+	};
+
+	for (int i = 0; i < 8; i++)
+	{
+		uint32_t value = pull();
+		cube.corners[i] = (uint8_t)((value & 7) + 8 * (value >> 3));
+	}
+	for (int i = 0; i < 12; i++)
+		cube.edges[i] = (uint8_t)pull();
+
+	return cube;
+}
@@ -0,0 +1,187 @@
+#include <cubie.hpp>
+
+// Face colors (URFDLB = 0..5) of each cubie in its solved slot, same order as the facelets
+static const uint8_t cornerColors[8][3] = {
+	{ 0, 1, 2 }, { 0, 2, 4 }, { 0, 4, 5 }, { 0, 5, 1 },
+	{ 3, 2, 1 }, { 3, 4, 2 }, { 3, 5, 4 }, { 3, 1, 5 }
+};
+static const uint8_t edgeColors[12][2] = {
+	{ 0, 1 }, { 0, 2 }, { 0, 4 }, { 0, 5 }, { 3, 1 }, { 3, 2 },
+	{ 3, 4 }, { 3, 5 }, { 2, 1 }, { 2, 4 }, { 5, 4 }, { 5, 1 }
+};
+
+CubieCube toCubie(const Cube3& cube)
+{
+	CubieCube cubie;
+
+	for (int i = 0; i < 8; i++)
+	{
+		cubie.cp[i] = (uint8_t)cube.corner_perm(i);
+		cubie.co[i] = (uint8_t)cube.corner_ori(i);
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		cubie.ep[i] = (uint8_t)cube.edge_perm(i);
+		cubie.eo[i] = (uint8_t)cube.edge_ori(i);
+	}
+
+	return cubie;
+}
+
+Cube3 fromCubie(const CubieCube& cubie)
+{
+	Cube3 cube;
+
+	for (int i = 0; i < 8; i++)
+		cube.corners[i] = cubie.cp[i] + 8 * cubie.co[i];
+	for (int i = 0; i < 12; i++)
+		cube.edges[i] = cubie.ep[i] | (cubie.eo[i] << 4);
+
+	return cube;
+}
+
+CubeError faceletsToCubie(const uint8_t* facelets, CubieCube& cubie)
+{
+	for (int i = 0; i < FACELET_COUNT; i++)
+	{
+		if (facelets[i] > 5)
+			return badFaceletColor;
+	}
+
+	for (int i = 0; i < 8; i++)
+	{
+		// Twist is how far the U/D colored facelet is from the slot's first facelet
+		int ori = 0;
+		while (ori < 3 && facelets[cornerFacelets[i][ori]] != 0 && facelets[cornerFacelets[i][ori]] != 3)
+			ori++;
+		if (ori == 3) return unknownCorner;
+
+		uint8_t col1 = facelets[cornerFacelets[i][(ori + 1) % 3]];
+		uint8_t col2 = facelets[cornerFacelets[i][(ori + 2) % 3]];
+
+		int j = 0;
+		while (j < 8 && !(cornerColors[j][0] == facelets[cornerFacelets[i][ori]]
+			&& cornerColors[j][1] == col1 && cornerColors[j][2] == col2))
+			j++;
+		if (j == 8) return unknownCorner;
+
+		cubie.cp[i] = (uint8_t)j;
+		cubie.co[i] = (uint8_t)ori;
+	}
+
+	for (int i = 0; i < 12; i++)
+	{
+		uint8_t a = facelets[edgeFacelets[i][0]];
+		uint8_t b = facelets[edgeFacelets[i][1]];
+
+		int j = 0;
+		for (; j < 12; j++)
+		{
+			if (edgeColors[j][0] == a && edgeColors[j][1] == b)
+			{
+				cubie.eo[i] = 0;
+				break;
+			}
+			if (edgeColors[j][0] == b && edgeColors[j][1] == a)
+			{
+				cubie.eo[i] = 1;
+				break;
+			}
+		}
+		if (j == 12) return unknownEdge;
+
+		cubie.ep[i] = (uint8_t)j;
+	}
+
+	return cubeValid;
+}
+
+void cubieToFacelets(const CubieCube& cubie, uint8_t* facelets)
+{
+	// Centers never move
+	for (int face = 0; face < 6; face++)
+		facelets[face * 9 + 4] = (uint8_t)face;
+
+	for (int i = 0; i < 8; i++)
+	{
+		for (int k = 0; k < 3; k++)
+			facelets[cornerFacelets[i][(k + cubie.co[i]) % 3]] = cornerColors[cubie.cp[i]][k];
+	}
+
+	for (int i = 0; i < 12; i++)
+	{
+		for (int k = 0; k < 2; k++)
+			facelets[edgeFacelets[i][(k + cubie.eo[i]) % 2]] = edgeColors[cubie.ep[i]][k];
+	}
+}
+
+// Parity of a permutation through its cycle decomposition: a cycle of length
+// L is L - 1 transpositions
+static int permutationParity(const uint8_t* perm, int count)
+{
+	uint32_t visited = 0;
+	int parity = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		if (visited & (1u << i)) continue;
+
+		int length = 0;
+		for (int j = i; !(visited & (1u << j)); j = perm[j])
+		{
+			visited |= 1u << j;
+			length++;
+		}
+		parity ^= (length - 1) & 1;
+	}
+
+	return parity;
+}
+
+CubeError validate(const CubieCube& cubie)
+{
+	uint32_t corners = 0, edges = 0;
+	int twist = 0, flip = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		if (cubie.cp[i] >= 8 || cubie.co[i] >= 3) return unknownCorner;
+		corners |= 1u << cubie.cp[i];
+		twist += cubie.co[i];
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		if (cubie.ep[i] >= 12 || cubie.eo[i] >= 2) return unknownEdge;
+		edges |= 1u << cubie.ep[i];
+		flip += cubie.eo[i];
+	}
+
+	if (corners != 0xFF) return duplicateCorner;
+	if (edges != 0xFFF) return duplicateEdge;
+	if (twist % 3 != 0) return cornerTwist;
+	if (flip % 2 != 0) return edgeFlip;
+	if (permutationParity(cubie.cp, 8) != permutationParity(cubie.ep, 12)) return parityError;
+
+	return cubeValid;
+}
+
+CubeError validate(const Cube3& cube)
+{
+	return validate(toCubie(cube));
+}
+
+const char* cubeErrorName(CubeError error)
+{
+	switch (error) {
+	case cubeValid: return "valid";
+	case badFaceletColor: return "facelet color out of range";
+	case unknownCorner: return "corner with impossible colors";
+	case unknownEdge: return "edge with impossible colors";
+	case duplicateCorner: return "corner appears twice";
+	case duplicateEdge: return "edge appears twice";
+	case cornerTwist: return "twisted corner";
+	case edgeFlip: return "flipped edge";
+	case parityError: return "corner and edge permutation parity differ";
+	}
+	return "unknown error";
+}
@@ -0,0 +1,166 @@
+#include <dataset.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static_assert(sizeof(DatasetRecord) == CUBE3_PACKED_BYTES + 1 + DATASET_MAX_SOLUTION, "records must not be padded");
+
+static uint64_t splitmix(uint64_t& state)
+{
+	uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+// Faces allowed after each face (row 0 is the first move): never the same face
+// again, and an opposite face only when it comes later in URFDLB order
+struct ScrambleFaces {
+	uint8_t faces[7][6];
+	uint8_t counts[7];
+};
+
+static constexpr ScrambleFaces scrambleFaces = [] {
+	ScrambleFaces table = {};
+	for (int lastFace = -1; lastFace < 6; lastFace++)
+	{
+		uint8_t count = 0;
+		for (int face = 0; face < 6; face++)
+		{
+			if (face == lastFace) continue;
+			if (lastFace >= 0 && face % 3 == lastFace % 3 && face < lastFace) continue;
+			table.faces[lastFace + 1][count++] = (uint8_t)face;
+		}
+		table.counts[lastFace + 1] = count;
+	}
+	return table;
+}();
+
+int randomScramble(uint64_t seed, uint64_t index, unsigned int length, uint8_t* moves)
+{
+	// Each record draws from its own stream, so the file does not depend on the
+	// thread count. The face rules keep the inverted scramble free of cancellations.
+	uint64_t state = seed ^ (index * 0xD1B54A32D192ED03ull);
+	int lastFace = -1, count = 0;
+
+	while (count < (int)length)
+	{
+		// One draw picks both the face and the power
+		uint64_t random = splitmix(state);
+		int face = scrambleFaces.faces[lastFace + 1][((random >> 32) * scrambleFaces.counts[lastFace + 1]) >> 32];
+		int power = (int)(((random & 0xFFFFFFFF) * 3) >> 32);
+
+		moves[count++] = (uint8_t)(face * 3 + power);
+		lastFace = face;
+	}
+
+	return count;
+}
+
+static void makeRecord(const DatasetOptions& options, uint64_t index, DatasetRecord& record)
+{
+	uint8_t scramble[DATASET_MAX_SOLUTION];
+	int length = randomScramble(options.seed, index, options.scrambleLength, scramble);
+
+	Cube3 cube;
+	for (int i = 0; i < length; i++)
+		cube.apply(scramble[i]);
+	packCube3(cube, std::span<uint8_t, CUBE3_PACKED_BYTES>(record.state, CUBE3_PACKED_BYTES));
+
+	memset(record.solution, DATASET_NO_MOVE, DATASET_MAX_SOLUTION);
+
+	int solutionLength = options.solver ? options.solver(cube, record.solution, DATASET_MAX_SOLUTION) : -1;
+	if (solutionLength < 0)
+	{
+		for (int i = 0; i < length; i++)
+			record.solution[i] = (uint8_t)inverseMove(scramble[length - 1 - i]);
+		solutionLength = length;
+	}
+
+	record.distance = (uint8_t)solutionLength;
+}
+
+bool writeDataset(const char* path, const DatasetOptions& options)
+{
+	if (options.scrambleLength > DATASET_MAX_SOLUTION)
+	{
+		std::cerr << "Scrambles are limited to " << DATASET_MAX_SOLUTION << " moves" << std::endl;
+		return false;
+	}
+
+	uint64_t size = sizeof(DatasetHeader) + options.recordCount * sizeof(DatasetRecord);
+	MappedFile file;
+	if (!file.create(path, size))
+		return false;
+
+	DatasetHeader header = {};
+	memcpy(header.magic, DATASET_MAGIC, sizeof(header.magic));
+	header.version = DATASET_VERSION;
+	header.recordSize = sizeof(DatasetRecord);
+	header.recordOffset = sizeof(DatasetHeader);
+	header.recordCount = options.recordCount;
+	header.seed = options.seed;
+	header.scrambleLength = options.scrambleLength;
+	header.exactDistances = options.solver && options.exactSolver ? 1 : 0;
+	memcpy(file.data(), &header, sizeof(header));
+
+	unsigned int threads = options.threads;
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	// Workers claim batches of records, build them in a private buffer and copy
+	// each finished batch into the mapping in one go
+	std::atomic<uint64_t> nextBatch = 0;
+	DatasetRecord* records = (DatasetRecord*)(file.data() + header.recordOffset);
+
+	auto worker = [&]() {
+		std::vector<DatasetRecord> buffer(DATASET_BATCH);
+
+		while (true)
+		{
+			uint64_t first = nextBatch.fetch_add(DATASET_BATCH);
+			if (first >= options.recordCount) break;
+
+			uint64_t count = options.recordCount - first < DATASET_BATCH ? options.recordCount - first : DATASET_BATCH;
+			for (uint64_t i = 0; i < count; i++)
+				makeRecord(options, first + i, buffer[i]);
+
+			memcpy(records + first, buffer.data(), count * sizeof(DatasetRecord));
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threads; i++)
+		workers.emplace_back(worker);
+	for (std::thread& thread : workers)
+		thread.join();
+
+	return file.flush();
+}
+
+bool DatasetReader::open(const char* path)
+{
+	if (!file.open_read(path))
+		return false;
+
+	const DatasetHeader* header = (const DatasetHeader*)file.data();
+	if (file.size() < sizeof(DatasetHeader) || memcmp(header->magic, DATASET_MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != DATASET_VERSION || header->recordSize != sizeof(DatasetRecord) ||
+		file.size() < header->recordOffset + header->recordCount * header->recordSize)
+	{
+		std::cerr << path << " is not a dataset this build can read" << std::endl;
+		file.close();
+		return false;
+	}
+
+	return true;
+}
+
+const DatasetRecord& DatasetReader::record(uint64_t index) const
+{
+	const DatasetHeader& h = header();
+	return *(const DatasetRecord*)(file.data() + h.recordOffset + index * h.recordSize);
+}
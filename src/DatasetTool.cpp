@@ -0,0 +1,139 @@
+#include <dataset.hpp>
+#include <solver.hpp>
+#include <cubie.hpp>
+#include <timestep.hpp>
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+
+static void printUsage()
+{
+	std::cout << "Usage:" << std::endl;
+	std::cout << "  RubikData write <file> <count> [scramble length] [threads] [seed] [corner table edge table]" << std::endl;
+	std::cout << "  RubikData read <file> <index>" << std::endl;
+}
+
+// The whole argument must be a number, anything else is reported through the usage
+static bool parseNumber(const char* text, uint64_t& value)
+{
+	const char* end = text + std::strlen(text);
+	auto [last, error] = std::from_chars(text, end, value);
+	return error == std::errc() && last == end;
+}
+
+static bool parseNumber(const char* text, unsigned int& value)
+{
+	uint64_t number = 0;
+	if (!parseNumber(text, number) || number > std::numeric_limits<unsigned int>::max())
+		return false;
+
+	value = (unsigned int)number;
+	return true;
+}
+
+static const PatternDatabase* datasetCorners = nullptr;
+static const PatternDatabase* datasetEdges = nullptr;
+
+static int solveOptimally(const Cube3& state, uint8_t* solution, int maxLength)
+{
+	// A Solver counts the nodes of its search, so every worker builds its own over
+	// the shared read-only tables. Records are already spread over the workers,
+	// each solve runs on one thread.
+	thread_local Solver solver(*datasetCorners, *datasetEdges);
+	return solver.solve(state, solution, maxLength, 1);
+}
+
+static int writeCommand(int argc, char** argv)
+{
+	DatasetOptions options;
+	if (!parseNumber(argv[3], options.recordCount) ||
+		(argc > 4 && !parseNumber(argv[4], options.scrambleLength)) ||
+		(argc > 5 && !parseNumber(argv[5], options.threads)) ||
+		(argc > 6 && !parseNumber(argv[6], options.seed)))
+	{
+		printUsage();
+		return 1;
+	}
+
+	PatternDatabase corners, edges;
+	if (argc > 8)
+	{
+		if (!corners.load(argv[7]) || !edges.load(argv[8]))
+			return 1;
+
+		datasetCorners = &corners;
+		datasetEdges = &edges;
+		options.solver = solveOptimally;
+		options.exactSolver = true;
+	}
+
+	double start = simulationClock();
+	if (!writeDataset(argv[2], options))
+		return 1;
+	double elapsed = simulationClock() - start;
+
+	std::cout << options.recordCount << " records written to " << argv[2] << " in " << elapsed << " s ("
+		<< options.recordCount / elapsed / 1e6 << " M records/s)" << std::endl;
+	return 0;
+}
+
+static int readCommand(char** argv)
+{
+	DatasetReader reader;
+	if (!reader.open(argv[2]))
+		return 1;
+
+	uint64_t index = 0;
+	if (!parseNumber(argv[3], index))
+	{
+		printUsage();
+		return 1;
+	}
+	if (index >= reader.size())
+	{
+		std::cerr << "Record " << index << " out of range, the file holds " << reader.size() << std::endl;
+		return 1;
+	}
+
+	const DatasetRecord& record = reader.record(index);
+	Cube3 cube = unpackCube3(std::span<const uint8_t, CUBE3_PACKED_BYTES>(record.state, CUBE3_PACKED_BYTES));
+
+	uint8_t facelets[FACELET_COUNT];
+	char text[FACELET_COUNT];
+	cubieToFacelets(toCubie(cube), facelets);
+	writeFaceletString(facelets, text);
+
+	std::cout << "State    : " << std::string_view(text, FACELET_COUNT) << std::endl;
+	std::cout << "Distance : " << (int)record.distance << (reader.header().exactDistances ? "" : " (upper bound)") << std::endl;
+	std::cout << "Solution :";
+	for (int i = 0; i < record.distance; i++)
+	{
+		std::cout << " " << moveName(record.solution[i]);
+		cube.apply(record.solution[i]);
+	}
+	std::cout << std::endl;
+
+	if (!cube.is_solved())
+	{
+		std::cerr << "Stored solution does not solve the state" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	std::string command = argc > 1 ? argv[1] : "";
+
+	if (command == "write" && argc >= 4)
+		return writeCommand(argc, argv);
+	if (command == "read" && argc >= 4)
+		return readCommand(argv);
+
+	printUsage();
+	return 1;
+}
@@ -0,0 +1,192 @@
+#include <face_textures.hpp>
+
+#include <cstring>
+
+FaceTextures::FaceTextures()
+{
+	persistent = GLEW_ARB_buffer_storage;
+	glGenTextures(1, &texture);
+}
+
+FaceTextures::~FaceTextures()
+{
+	release_buffer();
+	glDeleteTextures(1, &texture);
+}
+
+void FaceTextures::update(const CubeSnapshot& snapshot)
+{
+	// Lines a failed upload left dirty are retried even when the cube has not changed
+	if (!faces.sync(snapshot) && !faces.is_dirty()) return;
+
+	if (faces.size() != textureSize)
+		allocate(faces.size());
+
+	if (upload())
+		faces.clear_dirty();
+}
+
+unsigned int FaceTextures::get_texture() const
+{
+	return texture;
+}
+
+size_t FaceTextures::get_uploaded_bytes() const
+{
+	return uploadedBytes;
+}
+
+void FaceTextures::allocate(unsigned int size)
+{
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8UI, size, size, STICKER_FACES, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+	textureSize = size;
+
+	// A region holds the worst case, every face at once after a rebuild
+	release_buffer();
+	regionBytes = (size_t)STICKER_FACES * size * size;
+	glGenBuffers(1, &pbo);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+
+	if (persistent)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, regionBytes * FACE_STREAM_REGIONS, nullptr, flags);
+		mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, regionBytes * FACE_STREAM_REGIONS, flags));
+		persistent = mapped != nullptr;
+	}
+	if (!persistent)
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, regionBytes, nullptr, GL_STREAM_DRAW);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void FaceTextures::release_buffer()
+{
+	for (GLsync& fence : fences)
+	{
+		if (fence) glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	if (pbo && mapped)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	glDeleteBuffers(1, &pbo);
+	pbo = 0;
+	mapped = nullptr;
+	region = 0;
+}
+
+uint8_t* FaceTextures::begin_region()
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+
+	if (persistent)
+	{
+		// The region was last used FACE_STREAM_REGIONS uploads ago, normally long done
+		GLsync& fence = fences[region];
+		if (fence)
+		{
+			glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+		return mapped + region * regionBytes;
+	}
+
+	// Orphaned storage: the driver hands out fresh memory while the GPU still reads the old one
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, regionBytes, nullptr, GL_STREAM_DRAW);
+	return static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, regionBytes,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+}
+
+bool FaceTextures::end_region(size_t bytes)
+{
+	// The mapped store can be lost, for instance on a mode switch, and must be written again
+	if (!persistent && !glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return false;
+	}
+
+	size_t base = persistent ? region * regionBytes : 0;
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (const FaceUpload& upload : uploads)
+	{
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, upload.x, upload.y, upload.face, upload.width, upload.height, 1,
+			GL_RED_INTEGER, GL_UNSIGNED_BYTE, (void*)(base + upload.offset));
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (persistent)
+	{
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		region = (region + 1) % FACE_STREAM_REGIONS;
+	}
+	uploadedBytes = bytes;
+
+	return true;
+}
+
+bool FaceTextures::upload()
+{
+	unsigned int n = faces.size();
+	uint8_t* staging = begin_region();
+	if (!staging)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return false;
+	}
+
+	// Rows and columns are packed one after the other, a face with as many
+	// changed lines as it has rows goes up whole
+	uploads.clear();
+	size_t offset = 0;
+	for (int face = 0; face < STICKER_FACES; face++)
+	{
+		const uint8_t* colors = faces.face(face);
+
+		unsigned int lines = 0;
+		for (unsigned int k = 0; k < n; k++)
+			lines += faces.row_dirty(face, k) + faces.col_dirty(face, k);
+		if (!faces.face_dirty(face) && lines == 0) continue;
+
+		if (faces.face_dirty(face) || lines >= n)
+		{
+			std::memcpy(staging + offset, colors, n * n);
+			uploads.push_back({ face, 0, 0, n, n, offset });
+			offset += n * n;
+			continue;
+		}
+
+		for (unsigned int k = 0; k < n; k++)
+		{
+			if (faces.row_dirty(face, k))
+			{
+				std::memcpy(staging + offset, colors + k * n, n);
+				uploads.push_back({ face, 0, k, n, 1, offset });
+				offset += n;
+			}
+			if (faces.col_dirty(face, k))
+			{
+				for (unsigned int row = 0; row < n; row++)
+					staging[offset + row] = colors[row * n + k];
+				uploads.push_back({ face, k, 0, 1, n, offset });
+				offset += n;
+			}
+		}
+	}
+
+	return end_region(offset);
+}
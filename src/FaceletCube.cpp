@@ -0,0 +1,108 @@
+#include <facelet_cube.hpp>
+
+FaceletEngineDynamic::FaceletEngineDynamic(unsigned int n) : n(n), state(6 * n * n)
+{
+	int stickers = 6 * n * n;
+	for (int i = 0; i < stickers; i++)
+		state[i] = (uint8_t)(i / (n * n));
+
+	// Same construction as buildFaceletTables, flattened: cycles of move m are
+	// cycles[4 * cycleStart[m]] .. cycles[4 * cycleStart[m + 1]]
+	std::vector<bool> visited(stickers);
+	cycleStart.push_back(0);
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int layer = 0; layer < (int)n; layer++)
+		{
+			std::fill(visited.begin(), visited.end(), false);
+
+			for (int i = 0; i < stickers; i++)
+			{
+				StickerPos p = stickerPosition(n, i);
+				if (visited[i] || stickerLayer(n, p, axis) != layer) continue;
+
+				uint32_t cycle[4];
+				for (int k = 0; k < 4; k++)
+				{
+					cycle[k] = stickerIndex(n, p);
+					visited[cycle[k]] = true;
+					p = rotateSticker(p, axis);
+				}
+
+				if (cycle[1] == cycle[0]) continue;
+				cycles.insert(cycles.end(), cycle, cycle + 4);
+			}
+
+			cycleStart.push_back((uint32_t)(cycles.size() / 4));
+		}
+	}
+}
+
+void FaceletEngineDynamic::apply(const SliceMove* moves, size_t count)
+{
+	for (size_t m = 0; m < count; m++)
+	{
+		int index = moves[m].axis * n + moves[m].layer;
+		int shift = moves[m].turns & 3;
+
+		for (uint32_t c = cycleStart[index]; c < cycleStart[index + 1]; c++)
+		{
+			const uint32_t* cycle = &cycles[4 * c];
+			uint8_t v[4] = { state[cycle[0]], state[cycle[1]], state[cycle[2]], state[cycle[3]] };
+
+			for (int k = 0; k < 4; k++)
+				state[cycle[(k + shift) & 3]] = v[k];
+		}
+	}
+}
+
+bool FaceletEngineDynamic::is_solved() const
+{
+	for (size_t i = 0; i < state.size(); i++)
+	{
+		if (state[i] != state[(i / (n * n)) * n * n])
+			return false;
+	}
+	return true;
+}
+
+std::unique_ptr<FaceletEngine> makeFaceletEngine(unsigned int size)
+{
+	switch (size) {
+	case 2: return std::make_unique<FaceletEngineN<2>>();
+	case 3: return std::make_unique<FaceletEngineN<3>>();
+	case 4: return std::make_unique<FaceletEngineN<4>>();
+	case 5: return std::make_unique<FaceletEngineN<5>>();
+	case 6: return std::make_unique<FaceletEngineN<6>>();
+	case 7: return std::make_unique<FaceletEngineN<7>>();
+	default: return std::make_unique<FaceletEngineDynamic>(size);
+	}
+}
+
+SliceMove toSliceMove(RotationParams params)
+{
+	SliceMove move;
+	move.axis = params.dir == col ? 0 : params.dir == line ? 1 : 2;
+	move.layer = (uint16_t)params.faceIndex;
+	move.turns = moveAngle(params) > 0 ? 1 : 3;
+
+	return move;
+}
+
+SliceMove faceTurn(int move, unsigned int size)
+{
+	// move follows the Cube3 Move order: face (URFDLB) * 3 + quarter turns - 1.
+	// Clockwise seen from a face is -90 degrees about its outward axis.
+	int face = move / 3;
+	int quarters = move % 3 + 1;
+	int axis[6] = { 1, 0, 2, 1, 0, 2 };
+	bool positiveSide = face < 3;
+
+	SliceMove slice;
+	slice.axis = (uint8_t)axis[face];
+	slice.layer = (uint16_t)(positiveSide ? size - 1 : 0);
+	slice.turns = (uint8_t)((positiveSide ? 4 - quarters : quarters) & 3);
+
+	return slice;
+}
@@ -0,0 +1,79 @@
+#include <frame_pacer.hpp>
+#include <timestep.hpp>
+
+#include <chrono>
+#include <thread>
+
+FramePacer::FramePacer() : frameStart(simulationClock()), awakeUntil(frameStart + PACER_ACTIVE_TIME), periodStart(frameStart)
+{
+}
+
+void FramePacer::keep_awake()
+{
+	awakeUntil = simulationClock() + PACER_ACTIVE_TIME;
+}
+
+bool FramePacer::is_idle(const SETTINGS& settings) const
+{
+	return settings.idleThrottle && simulationClock() >= awakeUntil;
+}
+
+void FramePacer::end_frame(const SETTINGS& settings)
+{
+	double frameEnd = simulationClock();
+	workTime += frameEnd - frameStart;
+	frames++;
+
+	if (is_idle(settings))
+	{
+		glfwWaitEventsTimeout(settings.idleWait);
+
+		// Woken before the timeout means an event came in, ImGui needs a few
+		// frames to react to it and input may have queued a move
+		double woken = simulationClock();
+		if (woken - frameEnd < settings.idleWait)
+			keep_awake();
+
+		waitTime += woken - frameEnd;
+		idleTime += woken - frameEnd;
+	}
+	else
+	{
+		if (settings.frameCap > 0)
+			wait_until(frameStart + 1.0 / settings.frameCap);
+		waitTime += simulationClock() - frameEnd;
+
+		glfwPollEvents();
+	}
+
+	frameStart = simulationClock();
+
+	double period = frameStart - periodStart;
+	if (period >= PACER_STATS_PERIOD)
+	{
+		stats.framesPerSecond = (float)(frames / period);
+		stats.workPercent = (float)(workTime / period * 100.0);
+		stats.waitPercent = (float)(waitTime / period * 100.0);
+		stats.idlePercent = (float)(idleTime / period * 100.0);
+
+		periodStart = frameStart;
+		workTime = waitTime = idleTime = 0;
+		frames = 0;
+	}
+}
+
+const PacerStats& FramePacer::get_stats() const
+{
+	return stats;
+}
+
+void FramePacer::wait_until(double time)
+{
+	// Sleeps can overshoot by a scheduler slice, the last stretch is a yield loop
+	double remaining = time - simulationClock();
+	if (remaining > 0.002)
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining - 0.002));
+
+	while (simulationClock() < time)
+		std::this_thread::yield();
+}
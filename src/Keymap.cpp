@@ -0,0 +1,143 @@
+#include <keymap.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// Listed in the order they appear in the controls window
+static const KeyBinding bindings[] = {
+	{ GLFW_KEY_U, "U", "Up", "U", viewUp, 0, linesGroup },
+	{ GLFW_KEY_I, "I", "Inner Up", "u", viewUp, 1, linesGroup },
+	{ GLFW_KEY_E, "E", "Equator", "E", viewDown, MIDDLE_LAYER, linesGroup },
+	{ GLFW_KEY_D, "D", "Down", "D", viewDown, 0, linesGroup },
+	{ GLFW_KEY_S, "S", "Inner Down", "d", viewDown, 1, linesGroup },
+
+	{ GLFW_KEY_L, "L", "Left", "L", viewLeft, 0, colsGroup },
+	{ GLFW_KEY_K, "K", "Inner Left", "l", viewLeft, 1, colsGroup },
+	{ GLFW_KEY_M, "M", "Middle", "M", viewLeft, MIDDLE_LAYER, colsGroup },
+	{ GLFW_KEY_R, "R", "Right", "R", viewRight, 0, colsGroup },
+	{ GLFW_KEY_T, "T", "Inner Right", "r", viewRight, 1, colsGroup },
+
+	{ GLFW_KEY_F, "F", "Front", "F", viewFront, 0, facesGroup },
+	{ GLFW_KEY_C, "C", "Inner Front", "f", viewFront, 1, facesGroup },
+	{ GLFW_KEY_B, "B", "Back", "B", viewBack, 0, facesGroup },
+	{ GLFW_KEY_V, "V", "Inner Back", "b", viewBack, 1, facesGroup },
+};
+
+static const int bindingCount = sizeof(bindings) / sizeof(bindings[0]);
+
+// Signed axis index: 0 = +x, 1 = -x, 2 = +y, 3 = -y, 4 = +z, 5 = -z
+static const glm::ivec3 axisVectors[6] = {
+	{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+};
+
+static int axisIndex(glm::ivec3 v)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (axisVectors[i] == v) return i;
+	}
+	return -1;
+}
+
+static int snapToAxis(glm::vec3 v)
+{
+	glm::vec3 a = glm::abs(v);
+	if (a.x >= a.y && a.x >= a.z) return v.x > 0 ? 0 : 1;
+	if (a.y >= a.z) return v.y > 0 ? 2 : 3;
+	return v.z > 0 ? 4 : 5;
+}
+
+static FaceAxis toFaceAxis(int axis)
+{
+	// RotateDirection already names the axes: col turns about x, line about y, face about z
+	RotateDirection dirs[3] = { col, line, face };
+	return { dirs[axis / 2], axis % 2 == 0 ? 1 : -1 };
+}
+
+Keymap::Keymap()
+{
+	for (int i = 0; i < 6; i++)
+		for (int j = 0; j < 6; j++)
+			orientationIndex[i][j] = -1;
+
+	// An orientation is fixed by where the viewer's right and up point in cube space
+	int count = 0;
+	for (int right = 0; right < 6; right++)
+	{
+		for (int up = 0; up < 6; up++)
+		{
+			if (right / 2 == up / 2) continue;
+
+			glm::ivec3 r = axisVectors[right];
+			glm::ivec3 u = axisVectors[up];
+			glm::ivec3 f = glm::ivec3(r.y * u.z - r.z * u.y, r.z * u.x - r.x * u.z, r.x * u.y - r.y * u.x);
+
+			orientationIndex[right][up] = count;
+			orientations[count][viewRight] = toFaceAxis(right);
+			orientations[count][viewLeft] = toFaceAxis(axisIndex(-r));
+			orientations[count][viewUp] = toFaceAxis(up);
+			orientations[count][viewDown] = toFaceAxis(axisIndex(-u));
+			orientations[count][viewFront] = toFaceAxis(axisIndex(f));
+			orientations[count][viewBack] = toFaceAxis(axisIndex(-f));
+			count++;
+		}
+	}
+
+	for (int key = 0; key <= GLFW_KEY_LAST; key++)
+		keyToBinding[key] = -1;
+	for (int i = 0; i < bindingCount; i++)
+		keyToBinding[bindings[i].key] = i;
+}
+
+int Keymap::view_orientation(float rotationAngle, float flipAngle)
+{
+	// Camera orbits around y, the cube itself is flipped around x
+	glm::vec3 right = glm::vec3(cos(glm::radians(rotationAngle)), 0.0f, -sin(glm::radians(rotationAngle)));
+	glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+
+	glm::mat4 unflip = glm::rotate(glm::mat4(1.0f), glm::radians(-flipAngle), glm::vec3(1.0f, 0.0f, 0.0f));
+	right = glm::vec3(unflip * glm::vec4(right, 0.0f));
+	up = glm::vec3(unflip * glm::vec4(up, 0.0f));
+
+	return orientationIndex[snapToAxis(right)][snapToAxis(up)];
+}
+
+const KeyBinding* Keymap::find(int key)
+{
+	if (key < 0 || key > GLFW_KEY_LAST || keyToBinding[key] < 0) return nullptr;
+	return &bindings[keyToBinding[key]];
+}
+
+bool Keymap::is_available(const KeyBinding& binding, unsigned int cubeSize)
+{
+	if (binding.depth == MIDDLE_LAYER) return cubeSize % 2 == 1 && cubeSize >= 3;
+	return binding.depth < (int)cubeSize - 1 || binding.depth == 0;
+}
+
+bool Keymap::to_move(const KeyBinding& binding, int orientation, unsigned int cubeSize, bool inverse, RotationParams& params)
+{
+	if (orientation < 0 || !is_available(binding, cubeSize)) return false;
+
+	FaceAxis axis = orientations[orientation][binding.side];
+
+	int depth = binding.depth == MIDDLE_LAYER ? (cubeSize - 1) / 2 : binding.depth;
+	params.faceIndex = axis.sign > 0 ? cubeSize - 1 - depth : depth;
+	params.dir = axis.dir;
+
+	// Clockwise seen from the side is -90 degrees about the side's outward axis.
+	// Cube::rotate_face turns +90 about the axis when contrary is set, except for
+	// face moves which have their sign flipped.
+	bool positive = (axis.sign < 0) != inverse;
+	params.contrary = axis.dir == face ? !positive : positive;
+
+	return true;
+}
+
+const KeyBinding* Keymap::get_bindings()
+{
+	return bindings;
+}
+
+int Keymap::get_binding_count()
+{
+	return bindingCount;
+}
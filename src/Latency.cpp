@@ -0,0 +1,141 @@
+#include <latency.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+unsigned int LatencyTracker::key_pressed(double keyTime)
+{
+	if (!enabled) return 0;
+
+	// Moves that never reach the screen (cube reset, queue full) must not pile up
+	pending.erase(std::remove_if(pending.begin(), pending.end(),
+		[keyTime](LatencySample& s) { return keyTime - s.keyTime > LATENCY_TIMEOUT; }), pending.end());
+	if (pending.size() >= LATENCY_MAX_PENDING)
+		pending.erase(pending.begin());
+
+	LatencySample sample = {};
+	sample.inputId = nextInputId++;
+	sample.keyTime = keyTime;
+	pending.push_back(sample);
+
+	// 0 means "not tracked" everywhere down the pipeline
+	if (nextInputId == 0) nextInputId = 1;
+
+	return sample.inputId;
+}
+
+void LatencyTracker::frame_rendered(const CubeSnapshot& snapshot)
+{
+	if (!enabled || pending.empty()) return;
+
+	double now = simulationClock();
+
+	for (const SliceSnapshot& slice : snapshot.animations)
+	{
+		if (slice.inputId == 0 || slice.currentRotationAngle == 0.0f) continue;
+
+		for (size_t i = 0; i < pending.size(); i++)
+		{
+			if (pending[i].inputId != slice.inputId) continue;
+
+			pending[i].simStartTime = slice.startTime;
+			pending[i].firstFrameTime = now;
+			inFrame.push_back(pending[i]);
+			pending.erase(pending.begin() + i);
+			break;
+		}
+	}
+}
+
+void LatencyTracker::frame_presented(bool vsync)
+{
+	if (inFrame.empty()) return;
+
+	double now = simulationClock();
+
+	for (LatencySample& sample : inFrame)
+	{
+		sample.swapTime = now;
+		sample.vsync = vsync;
+
+		if (samples.size() < LATENCY_HISTORY)
+			samples.push_back(sample);
+		else
+			samples[nextSample] = sample;
+		nextSample = (nextSample + 1) % LATENCY_HISTORY;
+	}
+
+	inFrame.clear();
+}
+
+void LatencyTracker::clear()
+{
+	pending.clear();
+	inFrame.clear();
+	samples.clear();
+	nextSample = 0;
+}
+
+bool LatencyTracker::export_csv(const char* path)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cerr << "Failed to open " << path << " for writing" << std::endl;
+		return false;
+	}
+
+	file << "input_id,vsync,key_to_sim_ms,key_to_first_frame_ms,key_to_swap_ms\n";
+	for (LatencySample& sample : samples)
+	{
+		file << sample.inputId << ',' << (sample.vsync ? 1 : 0) << ','
+			<< (sample.simStartTime - sample.keyTime) * 1000.0 << ','
+			<< latency_ms(sample, false) << ','
+			<< latency_ms(sample, true) << '\n';
+	}
+
+	return true;
+}
+
+LatencyStats LatencyTracker::get_stats(bool toSwap)
+{
+	LatencyStats stats = {};
+	if (samples.empty()) return stats;
+
+	std::vector<float> values;
+	values.reserve(samples.size());
+	for (LatencySample& sample : samples)
+		values.push_back(latency_ms(sample, toSwap));
+	std::sort(values.begin(), values.end());
+
+	float sum = 0.0f;
+	for (float v : values) sum += v;
+
+	stats.count = (unsigned int)values.size();
+	stats.mean = sum / values.size();
+	stats.p50 = values[values.size() / 2];
+	stats.p95 = values[(values.size() * 95) / 100];
+	stats.max = values.back();
+
+	return stats;
+}
+
+void LatencyTracker::get_histogram(float* buckets, bool toSwap)
+{
+	for (int i = 0; i < LATENCY_BUCKETS; i++)
+		buckets[i] = 0.0f;
+
+	for (LatencySample& sample : samples)
+	{
+		int bucket = (int)(latency_ms(sample, toSwap) / LATENCY_BUCKET_MS);
+		if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+		buckets[bucket] += 1.0f;
+	}
+}
+
+float LatencyTracker::latency_ms(LatencySample& sample, bool toSwap)
+{
+	double end = toSwap ? sample.swapTime : sample.firstFrameTime;
+	return (float)((end - sample.keyTime) * 1000.0);
+}
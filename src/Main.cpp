@@ -1,23 +1,67 @@
 ﻿#include <window.hpp>
+#include <renderer.hpp>
 
 int main(void)
 {
+    StartupProfile startup;
     Window window;
 
-    if (!window.init())
+    if (!window.init(startup))
         return -1;
 
-    Cube* cube = new Cube();
+    Renderer renderer(startup);
+    startup.mark("Renderer");
+
+    Simulation simulation;
+    Scene scene;
+    FixedTimestep timestep;
+
+    simulation.start();
+    startup.mark("Simulation");
 
     while (!window.should_close())
     {
         window.clear();
-        window.draw_ui_frames(cube);
 
-        cube->draw(window.get_settings(), window.deltaTime);
+        const CubeSnapshot& snapshot = simulation.get_snapshot();
+        const SceneSnapshot& sceneSnapshot = scene.get_snapshot();
+        window.draw_ui_frames(simulation, snapshot, sceneSnapshot);
+
+        simulation.set_tick_rate(window.get_settings().tickRate);
+        simulation.set_turn_duration(window.get_settings().turnDuration);
+        timestep.set_tick_rate(window.get_settings().tickRate);
+        int ticks = timestep.advance(window.deltaTime);
+        for (int i = 0; i < ticks; i++)
+            window.tick(timestep.get_dt());
+
+        // The scene threads only run while it is shown, its cubes are built by size
+        // from the last reset and never stop turning
+        if (window.get_settings().showScene)
+        {
+            scene.set_layout(window.get_settings().sceneCubes, window.get_settings().cubeSize);
+            scene.set_tick_rate(window.get_settings().tickRate);
+            scene.set_turn_duration(window.get_settings().turnDuration);
+            scene.start();
+
+            renderer.draw_scene(sceneSnapshot, window.get_camera(timestep.get_alpha()), scene.get_alpha(sceneSnapshot));
+            window.keep_awake();
+        }
+        else
+        {
+            scene.stop();
+
+            // Frames keep coming while the shaders and texture load in the background
+            if (!renderer.draw(snapshot, window.get_camera(timestep.get_alpha()), simulation.get_alpha(snapshot)))
+                window.keep_awake();
+        }
+
+        window.update(snapshot);
 
-        window.update();
+        if (!startup.has_first_frame())
+            startup.first_frame();
     }
+    simulation.stop();
+    scene.stop();
     window.cleanup_imGui();
 
     return 0;
@@ -0,0 +1,182 @@
+#include <mapped_file.hpp>
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open_read(const char* path)
+{
+	close();
+
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		std::cerr << "Failed to open " << path << std::endl;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	length = (uint64_t)fileSize.QuadPart;
+
+	mappingHandle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle)
+		mapping = (uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+	if (!mapping)
+	{
+		std::cerr << "Failed to map " << path << std::endl;
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+bool MappedFile::create(const char* path, uint64_t size)
+{
+	close();
+
+	file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		std::cerr << "Failed to create " << path << std::endl;
+		return false;
+	}
+
+	length = size;
+	mappingHandle = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, NULL);
+	if (mappingHandle)
+		mapping = (uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, 0);
+
+	if (!mapping)
+	{
+		std::cerr << "Failed to map " << path << " (" << size << " bytes)" << std::endl;
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+bool MappedFile::flush()
+{
+	return mapping && FlushViewOfFile(mapping, 0) && FlushFileBuffers(file);
+}
+
+void MappedFile::close()
+{
+	if (mapping) UnmapViewOfFile(mapping);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (file) CloseHandle(file);
+
+	mapping = nullptr;
+	mappingHandle = nullptr;
+	file = nullptr;
+	length = 0;
+}
+
+#else
+
+bool MappedFile::open_read(const char* path)
+{
+	close();
+
+	fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		std::cerr << "Failed to open " << path << std::endl;
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		std::cerr << "Failed to read the size of " << path << std::endl;
+		close();
+		return false;
+	}
+	length = (uint64_t)info.st_size;
+
+	void* address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	if (address == MAP_FAILED)
+	{
+		std::cerr << "Failed to map " << path << std::endl;
+		close();
+		return false;
+	}
+
+	mapping = (uint8_t*)address;
+	return true;
+}
+
+bool MappedFile::create(const char* path, uint64_t size)
+{
+	close();
+
+	fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+	{
+		std::cerr << "Failed to create " << path << std::endl;
+		return false;
+	}
+
+	// Extending with ftruncate leaves a sparse file, blocks are only allocated as pages are written
+	if (ftruncate(fd, (off_t)size) != 0)
+	{
+		std::cerr << "Failed to resize " << path << " to " << size << " bytes" << std::endl;
+		close();
+		return false;
+	}
+	length = size;
+
+	void* address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (address == MAP_FAILED)
+	{
+		std::cerr << "Failed to map " << path << " (" << size << " bytes)" << std::endl;
+		close();
+		return false;
+	}
+
+	mapping = (uint8_t*)address;
+	return true;
+}
+
+bool MappedFile::flush()
+{
+	return mapping && msync(mapping, length, MS_SYNC) == 0;
+}
+
+void MappedFile::close()
+{
+	if (mapping) munmap(mapping, length);
+	if (fd >= 0) ::close(fd);
+
+	mapping = nullptr;
+	fd = -1;
+	length = 0;
+}
+
+#endif
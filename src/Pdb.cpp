@@ -0,0 +1,470 @@
+#include <pdb.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+// Default edge groups. The first six are mapped onto the other six by the x2
+// rotation, so one 6-edge table bounds both halves of the edges.
+static const uint8_t defaultEdges[PDB_MAX_EDGES] = { UR, UF, UL, UB, FR, FL, DR };
+
+PdbSpec cornerSpec()
+{
+	return { cornerPdb, 0, {} };
+}
+
+PdbSpec edgeSpec(int count)
+{
+	PdbSpec spec = { edgePdb, (uint8_t)count, {} };
+	for (int i = 0; i < count; i++)
+		spec.edges[i] = defaultEdges[i];
+	return spec;
+}
+
+uint64_t pdbStateCount(const PdbSpec& spec)
+{
+	if (spec.kind == cornerPdb) return CORNER_PDB_STATES;
+
+	// 12 * 11 * ... placements of the tracked edges, times their flips
+	uint64_t count = 1;
+	for (int i = 0; i < spec.edgeCount; i++)
+		count *= 12 - i;
+	return count << spec.edgeCount;
+}
+
+bool pdbSpecValid(const PdbSpec& spec)
+{
+	if (spec.kind == cornerPdb) return true;
+	if (spec.kind != edgePdb || spec.edgeCount < 1 || spec.edgeCount > PDB_MAX_EDGES) return false;
+
+	bool seen[12] = {};
+	for (int i = 0; i < spec.edgeCount; i++)
+	{
+		if (spec.edges[i] >= 12 || seen[spec.edges[i]]) return false;
+		seen[spec.edges[i]] = true;
+	}
+	return true;
+}
+
+static uint32_t cornerPermIndex(const Cube3& cube)
+{
+	uint32_t index = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		int smaller = 0;
+		for (int j = i + 1; j < 8; j++)
+			smaller += cube.corner_perm(j) < cube.corner_perm(i);
+		index = index * (8 - i) + smaller;
+	}
+	return index;
+}
+
+static uint32_t cornerTwistIndex(const Cube3& cube)
+{
+	uint32_t index = 0;
+	for (int i = 0; i < 7; i++)
+		index = index * 3 + cube.corner_ori(i);
+	return index;
+}
+
+static void setCornerPerm(Cube3& cube, uint32_t index)
+{
+	int digits[8];
+	for (int i = 7; i >= 0; i--)
+	{
+		digits[i] = index % (8 - i);
+		index /= 8 - i;
+	}
+
+	// Digit i picks the digits[i]-th smallest corner not placed yet
+	bool used[8] = {};
+	for (int i = 0; i < 8; i++)
+	{
+		int corner = 0;
+		for (int skip = digits[i]; used[corner] || skip > 0; corner++)
+		{
+			if (!used[corner]) skip--;
+		}
+		used[corner] = true;
+		cube.corners[i] = (uint8_t)(corner + 8 * cube.corner_ori(i));
+	}
+}
+
+static void setCornerTwist(Cube3& cube, uint32_t index)
+{
+	int sum = 0;
+	for (int i = 6; i >= 0; i--)
+	{
+		int twist = index % 3;
+		index /= 3;
+		sum += twist;
+		cube.corners[i] = (uint8_t)(cube.corner_perm(i) + 8 * twist);
+	}
+	cube.corners[7] = (uint8_t)(cube.corner_perm(7) + 8 * ((3 - sum % 3) % 3));
+}
+
+// Corners step through small perm and twist tables. Edge patterns are decoded
+// and re-ranked, with each move as a slot mapping plus a flip per slot.
+struct CornerMoveTables {
+	uint16_t perm[CORNER_PERMS][CUBE3_MOVES];
+	uint16_t twist[CORNER_TWISTS][CUBE3_MOVES];
+};
+
+struct EdgeMoveTables {
+	uint8_t dest[CUBE3_MOVES][12];
+	uint8_t flip[CUBE3_MOVES][12];
+};
+
+static const CornerMoveTables& cornerTables()
+{
+	static const CornerMoveTables* tables = [] {
+		CornerMoveTables* t = new CornerMoveTables;
+		for (int move = 0; move < CUBE3_MOVES; move++)
+		{
+			for (uint32_t p = 0; p < CORNER_PERMS; p++)
+			{
+				Cube3 cube;
+				setCornerPerm(cube, p);
+				cube.apply(move);
+				t->perm[p][move] = (uint16_t)cornerPermIndex(cube);
+			}
+			for (uint32_t w = 0; w < CORNER_TWISTS; w++)
+			{
+				Cube3 cube;
+				setCornerTwist(cube, w);
+				cube.apply(move);
+				t->twist[w][move] = (uint16_t)cornerTwistIndex(cube);
+			}
+		}
+		return t;
+	}();
+
+	return *tables;
+}
+
+static constexpr EdgeMoveTables edgeTables = [] {
+	// Slot i takes the edge from edgeShuffle[i], so that edge's new slot is i
+	EdgeMoveTables t = {};
+	for (int move = 0; move < CUBE3_MOVES; move++)
+	{
+		const Cube3Move& m = cube3Tables.moves[move];
+		for (int i = 0; i < 12; i++)
+		{
+			t.dest[move][m.edgeShuffle[i]] = (uint8_t)i;
+			t.flip[move][i] = m.edgeFlip[i] >> 4;
+		}
+	}
+	return t;
+}();
+
+static uint64_t edgeRank(int count, const uint8_t* slots, const uint8_t* flips)
+{
+	// Slot i is ranked among the slots still free, in base 12 - i
+	uint64_t rank = 0;
+	uint32_t flipBits = 0;
+	for (int i = 0; i < count; i++)
+	{
+		int smaller = 0;
+		for (int j = 0; j < i; j++)
+			smaller += slots[j] < slots[i];
+		rank = rank * (12 - i) + slots[i] - smaller;
+		flipBits = flipBits << 1 | flips[i];
+	}
+	return rank << count | flipBits;
+}
+
+static void edgeUnrank(int count, uint64_t index, uint8_t* slots, uint8_t* flips)
+{
+	for (int i = count - 1; i >= 0; i--)
+	{
+		flips[i] = index & 1;
+		index >>= 1;
+	}
+
+	int digits[PDB_MAX_EDGES];
+	for (int i = count - 1; i >= 0; i--)
+	{
+		digits[i] = (int)(index % (12 - i));
+		index /= 12 - i;
+	}
+
+	bool used[12] = {};
+	for (int i = 0; i < count; i++)
+	{
+		int slot = 0;
+		for (int skip = digits[i]; used[slot] || skip > 0; slot++)
+		{
+			if (!used[slot]) skip--;
+		}
+		used[slot] = true;
+		slots[i] = (uint8_t)slot;
+	}
+}
+
+uint64_t pdbIndex(const PdbSpec& spec, const Cube3& cube)
+{
+	if (spec.kind == cornerPdb)
+		return (uint64_t)cornerPermIndex(cube) * CORNER_TWISTS + cornerTwistIndex(cube);
+
+	uint8_t slotOf[16] = {};
+	for (int slot = 0; slot < 12; slot++)
+		slotOf[cube.edge_perm(slot)] = (uint8_t)slot;
+
+	uint8_t slots[PDB_MAX_EDGES], flips[PDB_MAX_EDGES];
+	for (int i = 0; i < spec.edgeCount; i++)
+	{
+		slots[i] = slotOf[spec.edges[i]];
+		flips[i] = (uint8_t)cube.edge_ori(slots[i]);
+	}
+	return edgeRank(spec.edgeCount, slots, flips);
+}
+
+static void pdbNeighbors(const PdbSpec& spec, uint64_t index, uint64_t* neighbors)
+{
+	if (spec.kind == cornerPdb)
+	{
+		const CornerMoveTables& tables = cornerTables();
+		uint32_t perm = (uint32_t)(index / CORNER_TWISTS), twist = (uint32_t)(index % CORNER_TWISTS);
+		for (int move = 0; move < CUBE3_MOVES; move++)
+			neighbors[move] = (uint64_t)tables.perm[perm][move] * CORNER_TWISTS + tables.twist[twist][move];
+		return;
+	}
+
+	uint8_t slots[PDB_MAX_EDGES], flips[PDB_MAX_EDGES];
+	edgeUnrank(spec.edgeCount, index, slots, flips);
+
+	for (int move = 0; move < CUBE3_MOVES; move++)
+	{
+		uint8_t movedSlots[PDB_MAX_EDGES], movedFlips[PDB_MAX_EDGES];
+		for (int i = 0; i < spec.edgeCount; i++)
+		{
+			movedSlots[i] = edgeTables.dest[move][slots[i]];
+			movedFlips[i] = flips[i] ^ edgeTables.flip[move][movedSlots[i]];
+		}
+		neighbors[move] = edgeRank(spec.edgeCount, movedSlots, movedFlips);
+	}
+}
+
+bool PatternDatabase::generate(const PdbSpec& spec, unsigned int threads)
+{
+	if (!pdbSpecValid(spec))
+	{
+		std::cerr << "Pattern database spec is not a valid corner or edge pattern" << std::endl;
+		return false;
+	}
+
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	uint64_t states = pdbStateCount(spec);
+
+	file.close();
+	data = nullptr;
+	generated.assign((size_t)((states + 1) / 2), 0xFF);
+	header = {};
+	memcpy(header.magic, PDB_MAGIC, sizeof(header.magic));
+	header.version = PDB_VERSION;
+	header.format = nibbleFormat;
+	header.spec = spec;
+	header.stateCount = states;
+
+	uint8_t* table = generated.data();
+	auto get = [&](uint64_t index) {
+		return (std::atomic_ref<uint8_t>(table[index >> 1]).load(std::memory_order_relaxed) >> ((index & 1) * 4)) & 0xF;
+	};
+	// A state only ever goes from unvisited to its depth, so concurrent fetch_and
+	// on a shared byte cannot undo a mark made by another thread
+	auto mark = [&](uint64_t index, int depth) {
+		int shift = (index & 1) * 4;
+		uint8_t before = std::atomic_ref<uint8_t>(table[index >> 1]).fetch_and((uint8_t)~((PDB_UNVISITED ^ depth) << shift));
+		return ((before >> shift) & 0xF) == PDB_UNVISITED;
+	};
+
+	mark(pdbIndex(spec, Cube3()), 0);
+	header.distribution[0] = 1;
+
+	uint64_t visited = 1;
+	for (int depth = 0; visited < states && depth + 1 < PDB_UNVISITED; depth++)
+	{
+		// Forward from the frontier while it is small, then backward from the unvisited states
+		bool backward = visited > states / 4;
+		std::atomic<uint64_t> found = 0;
+
+		auto worker = [&](uint64_t begin, uint64_t end) {
+			uint64_t count = 0;
+			uint64_t neighbors[CUBE3_MOVES];
+
+			for (uint64_t index = begin; index < end; index++)
+			{
+				int value = get(index);
+
+				if (backward)
+				{
+					if (value != PDB_UNVISITED) continue;
+
+					pdbNeighbors(spec, index, neighbors);
+					for (int move = 0; move < CUBE3_MOVES; move++)
+					{
+						if (get(neighbors[move]) == depth)
+						{
+							count += mark(index, depth + 1);
+							break;
+						}
+					}
+				}
+				else
+				{
+					if (value != depth) continue;
+
+					pdbNeighbors(spec, index, neighbors);
+					for (int move = 0; move < CUBE3_MOVES; move++)
+					{
+						if (get(neighbors[move]) == PDB_UNVISITED)
+							count += mark(neighbors[move], depth + 1);
+					}
+				}
+			}
+			found += count;
+		};
+
+		uint64_t chunk = (states + threads - 1) / threads;
+		std::vector<std::thread> workers;
+		for (unsigned int i = 0; i < threads; i++)
+		{
+			uint64_t begin = i * chunk, end = begin + chunk < states ? begin + chunk : states;
+			if (begin < end)
+				workers.emplace_back(worker, begin, end);
+		}
+		for (std::thread& thread : workers)
+			thread.join();
+
+		if (found == 0) break;
+
+		header.distribution[depth + 1] = found;
+		header.maxDepth = depth + 1;
+		visited += found;
+	}
+
+	data = table;
+	return visited == states;
+}
+
+bool PatternDatabase::save(const char* path, PdbFormat format) const
+{
+	if (!data || header.format != nibbleFormat) return false;
+
+	std::ofstream out(path, std::ios::binary);
+	if (!out)
+	{
+		std::cerr << "Failed to open " << path << " for writing" << std::endl;
+		return false;
+	}
+
+	PdbHeader saved = header;
+	saved.format = format;
+	out.write((const char*)&saved, sizeof(saved));
+
+	if (format == nibbleFormat)
+	{
+		out.write((const char*)data, (std::streamsize)((header.stateCount + 1) / 2));
+		return (bool)out;
+	}
+
+	// Repack 4 residues per byte through a small buffer
+	std::vector<uint8_t> buffer(1 << 16);
+	size_t used = 0;
+	for (uint64_t index = 0; index < header.stateCount; index += 4)
+	{
+		uint8_t packed = 0;
+		for (uint64_t i = index; i < index + 4 && i < header.stateCount; i++)
+			packed |= (uint8_t)((distance(i) % 3) << ((i & 3) * 2));
+
+		buffer[used++] = packed;
+		if (used == buffer.size())
+		{
+			out.write((const char*)buffer.data(), (std::streamsize)used);
+			used = 0;
+		}
+	}
+	out.write((const char*)buffer.data(), (std::streamsize)used);
+
+	return (bool)out;
+}
+
+bool PatternDatabase::load(const char* path)
+{
+	// Mapped rather than read, so startup does not wait for hundreds of MB and
+	// the OS pages in whatever the search actually touches
+	generated.clear();
+	data = nullptr;
+	if (!file.open_read(path))
+		return false;
+
+	bool valid = file.size() >= sizeof(PdbHeader);
+	if (valid)
+	{
+		memcpy(&header, file.data(), sizeof(header));
+		uint64_t expected = header.format == mod3Format ? (header.stateCount + 3) / 4 : (header.stateCount + 1) / 2;
+		// The spec is checked before its state count, which trusts it
+		valid = memcmp(header.magic, PDB_MAGIC, sizeof(header.magic)) == 0 && header.version == PDB_VERSION &&
+			pdbSpecValid(header.spec) && header.stateCount == pdbStateCount(header.spec) && file.size() == sizeof(PdbHeader) + expected;
+	}
+
+	if (!valid)
+	{
+		std::cerr << path << " is not a pattern database this build can read" << std::endl;
+		file.close();
+		return false;
+	}
+
+	data = file.data() + sizeof(PdbHeader);
+	return true;
+}
+
+int PatternDatabase::residue(uint64_t index) const
+{
+	return (data[index >> 2] >> ((index & 3) * 2)) & 3;
+}
+
+int PatternDatabase::distance(uint64_t index) const
+{
+	if (header.format == nibbleFormat)
+		return (data[index >> 1] >> ((index & 1) * 4)) & 0xF;
+
+	// Walk down to the goal, each step goes to the neighbor one residue lower
+	uint64_t goal = pdbIndex(header.spec, Cube3());
+	uint64_t neighbors[CUBE3_MOVES];
+	int depth = 0;
+
+	while (index != goal && depth < PDB_MAX_DEPTH)
+	{
+		int wanted = (residue(index) + 2) % 3;
+		pdbNeighbors(header.spec, index, neighbors);
+
+		int move = 0;
+		while (move < CUBE3_MOVES && residue(neighbors[move]) != wanted) move++;
+		if (move == CUBE3_MOVES) return -1;
+
+		index = neighbors[move];
+		depth++;
+	}
+	return depth;
+}
+
+int PatternDatabase::distance(uint64_t index, int parentDistance) const
+{
+	if (header.format == nibbleFormat)
+		return (data[index >> 1] >> ((index & 1) * 4)) & 0xF;
+
+	// The state is within one move of the parent, so its distance is one of
+	// parentDistance - 1, parentDistance or parentDistance + 1
+	int difference = (residue(index) - parentDistance % 3 + 3) % 3;
+	return difference == 0 ? parentDistance : difference == 1 ? parentDistance + 1 : parentDistance - 1;
+}
+
+int PatternDatabase::lookup(const Cube3& cube) const
+{
+	return distance(pdbIndex(header.spec, cube));
+}
@@ -0,0 +1,349 @@
+#include <piece_transforms.hpp>
+
+#include <cstring>
+
+#define HOME_ARRAY 0
+#define POS_ARRAY 3
+
+struct RotationTables {
+	glm::quat quats[CUBE_ROTATIONS];
+	glm::mat3 matrices[CUBE_ROTATIONS];
+	uint8_t turns[3][2][CUBE_ROTATIONS];
+};
+
+static bool sameRotation(const glm::mat3& a, const glm::mat3& b)
+{
+	for (int c = 0; c < 3; c++)
+	{
+		if (glm::round(a[c]) != glm::round(b[c])) return false;
+	}
+	return true;
+}
+
+static RotationTables buildRotationTables()
+{
+	// Grown from the identity by quarter turns about x, y and z
+	RotationTables tables = {};
+	int count = 1;
+	tables.quats[0] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+	auto find = [&](glm::quat q) {
+		glm::mat3 m = glm::mat3_cast(q);
+		for (int r = 0; r < count; r++)
+		{
+			if (sameRotation(m, glm::mat3_cast(tables.quats[r]))) return r;
+		}
+		return -1;
+	};
+
+	for (int r = 0; r < count; r++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			glm::vec3 turnAxis(0.0f);
+			turnAxis[axis] = 1.0f;
+			glm::quat q = glm::normalize(glm::angleAxis(glm::radians(90.0f), turnAxis) * tables.quats[r]);
+			if (find(q) < 0) tables.quats[count++] = q;
+		}
+	}
+
+	for (int r = 0; r < CUBE_ROTATIONS; r++)
+	{
+		// Exact entries, so turned normals and model matrices never need rounding
+		glm::mat3 m = glm::mat3_cast(tables.quats[r]);
+		tables.matrices[r] = glm::mat3(glm::round(m[0]), glm::round(m[1]), glm::round(m[2]));
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			glm::vec3 turnAxis(0.0f);
+			turnAxis[axis] = 1.0f;
+			for (int positive = 0; positive < 2; positive++)
+			{
+				glm::quat turn = glm::angleAxis(glm::radians(positive ? 90.0f : -90.0f), turnAxis);
+				tables.turns[axis][positive][r] = (uint8_t)find(turn * tables.quats[r]);
+			}
+		}
+	}
+
+	return tables;
+}
+
+static const RotationTables rotationTables = buildRotationTables();
+
+static size_t paddedCount(size_t count)
+{
+	return (count + PIECE_LANES - 1) & ~(size_t)(PIECE_LANES - 1);
+}
+
+static size_t blockBytes(size_t stride)
+{
+	return (PIECE_FLOAT_ARRAYS * sizeof(float) + sizeof(uint8_t)) * stride;
+}
+
+PieceTransforms::PieceTransforms(std::pmr::memory_resource* resource) : resource(resource), data(nullptr), count(0), stride(0)
+{
+}
+
+PieceTransforms::PieceTransforms(const PieceTransforms& other)
+	: resource(std::pmr::get_default_resource()), data(nullptr), count(0), stride(0)
+{
+	*this = other;
+}
+
+PieceTransforms& PieceTransforms::operator=(const PieceTransforms& other)
+{
+	if (this == &other) return *this;
+
+	// Snapshots are refilled every tick, the block is only replaced when its layout
+	// changes, so it keeps matching the source byte for byte
+	count = 0;
+	if (stride != paddedCount(other.count))
+		allocate(paddedCount(other.count));
+
+	count = other.count;
+	for (int k = 0; k < PIECE_FLOAT_ARRAYS; k++)
+		std::memcpy(array(k), other.array(k), paddedCount(count) * sizeof(float));
+	std::memcpy(rotations(), other.rotations(), paddedCount(count));
+
+	return *this;
+}
+
+PieceTransforms::~PieceTransforms()
+{
+	if (data)
+		resource->deallocate(data, blockBytes(stride), PIECE_ALIGNMENT);
+}
+
+void PieceTransforms::reserve(size_t newCount)
+{
+	if (newCount > stride)
+		allocate(paddedCount(newCount));
+}
+
+size_t PieceTransforms::size() const
+{
+	return count;
+}
+
+bool PieceTransforms::empty() const
+{
+	return count == 0;
+}
+
+void PieceTransforms::resize(size_t newCount)
+{
+	if (newCount > stride)
+		allocate(paddedCount(newCount));
+
+	// Dropped pieces become padding again, the identity at the origin
+	if (newCount < count)
+	{
+		for (int k = 0; k < PIECE_FLOAT_ARRAYS; k++)
+			std::memset(array(k) + newCount, 0, (count - newCount) * sizeof(float));
+		std::memset(rotations() + newCount, 0, count - newCount);
+	}
+
+	count = newCount;
+}
+
+void PieceTransforms::copy_pieces(size_t first, const PieceTransforms& other)
+{
+	for (int k = 0; k < PIECE_FLOAT_ARRAYS; k++)
+		std::memcpy(array(k) + first, other.array(k), other.count * sizeof(float));
+	std::memcpy(rotations() + first, other.rotations(), other.count);
+}
+
+void PieceTransforms::add(glm::vec3 home)
+{
+	if (count == stride)
+		allocate(paddedCount(count * 2 + 1));
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		array(HOME_ARRAY + axis)[count] = home[axis];
+		array(POS_ARRAY + axis)[count] = home[axis];
+	}
+	rotations()[count] = 0;
+
+	count++;
+}
+
+glm::vec3 PieceTransforms::get_home(size_t index) const
+{
+	return glm::vec3(array(HOME_ARRAY)[index], array(HOME_ARRAY + 1)[index], array(HOME_ARRAY + 2)[index]);
+}
+
+glm::vec3 PieceTransforms::get_pos(size_t index) const
+{
+	return glm::vec3(array(POS_ARRAY)[index], array(POS_ARRAY + 1)[index], array(POS_ARRAY + 2)[index]);
+}
+
+void PieceTransforms::set_pos(size_t index, glm::vec3 pos)
+{
+	for (int axis = 0; axis < 3; axis++)
+		array(POS_ARRAY + axis)[index] = pos[axis];
+}
+
+uint8_t PieceTransforms::get_rotation(size_t index) const
+{
+	return rotations()[index];
+}
+
+void PieceTransforms::set_rotation(size_t index, uint8_t rotation)
+{
+	rotations()[index] = rotation;
+}
+
+glm::quat PieceTransforms::get_orientation(size_t index) const
+{
+	return rotationQuat(rotations()[index]);
+}
+
+const void* PieceTransforms::block() const
+{
+	return data;
+}
+
+size_t PieceTransforms::block_bytes() const
+{
+	return blockBytes(stride);
+}
+
+const float* PieceTransforms::home_array(int axis) const
+{
+	return array(HOME_ARRAY + axis);
+}
+
+const float* PieceTransforms::pos_array(int axis) const
+{
+	return array(POS_ARRAY + axis);
+}
+
+const uint8_t* PieceTransforms::rotation_array() const
+{
+	return rotations();
+}
+
+void PieceTransforms::turn_slice(int axis, float layer, bool positive)
+{
+	// Positions are half-integers, so the quarter turn is an exact swap and
+	// negation of the two other coordinates: (u, v) becomes (-v, u) at +90 degrees.
+	// Orientations move along the turn table, no quaternion is touched.
+	int u = (axis + 1) % 3, v = (axis + 2) % 3;
+	float sign = positive ? 1.0f : -1.0f;
+	const uint8_t* turn = rotationTables.turns[axis][positive];
+
+	// Row 0 keeps the rotation and row 1 turns it, indexed by the lane mask.
+	// Slice pieces are scattered through the arrays, so any branch on the mask mispredicts.
+	uint8_t lookup[2][CUBE_ROTATIONS];
+	for (int r = 0; r < CUBE_ROTATIONS; r++)
+	{
+		lookup[0][r] = (uint8_t)r;
+		lookup[1][r] = turn[r];
+	}
+
+	const float* posA = array(POS_ARRAY + axis);
+	float* posU = array(POS_ARRAY + u);
+	float* posV = array(POS_ARRAY + v);
+	uint8_t* rotation = rotations();
+	size_t end = paddedCount(count);
+
+#ifdef PIECE_SIMD
+	const __m128 target = _mm_set1_ps(layer);
+	const __m128 signs = _mm_set1_ps(sign);
+
+	for (size_t i = 0; i < end; i += PIECE_LANES)
+	{
+		__m128 mask = _mm_cmpeq_ps(_mm_load_ps(posA + i), target);
+		int lanes = _mm_movemask_ps(mask);
+
+		__m128 pu = _mm_load_ps(posU + i), pv = _mm_load_ps(posV + i);
+		__m128 nu = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(signs, pv));
+		__m128 nv = _mm_mul_ps(signs, pu);
+
+		_mm_store_ps(posU + i, _mm_or_ps(_mm_and_ps(mask, nu), _mm_andnot_ps(mask, pu)));
+		_mm_store_ps(posV + i, _mm_or_ps(_mm_and_ps(mask, nv), _mm_andnot_ps(mask, pv)));
+
+		for (int lane = 0; lane < PIECE_LANES; lane++)
+			rotation[i + lane] = lookup[lanes >> lane & 1][rotation[i + lane]];
+	}
+#else
+	for (size_t i = 0; i < end; i++)
+	{
+		if (posA[i] != layer) continue;
+
+		float pu = posU[i], pv = posV[i];
+		posU[i] = -sign * pv;
+		posV[i] = sign * pu;
+		rotation[i] = turn[rotation[i]];
+	}
+#endif
+}
+
+float* PieceTransforms::array(int index)
+{
+	return data + index * stride;
+}
+
+const float* PieceTransforms::array(int index) const
+{
+	return data + index * stride;
+}
+
+uint8_t* PieceTransforms::rotations()
+{
+	return reinterpret_cast<uint8_t*>(data + PIECE_FLOAT_ARRAYS * stride);
+}
+
+const uint8_t* PieceTransforms::rotations() const
+{
+	return reinterpret_cast<const uint8_t*>(data + PIECE_FLOAT_ARRAYS * stride);
+}
+
+void PieceTransforms::allocate(size_t newStride)
+{
+	// Padding lanes hold the identity at the origin so SIMD loops stay finite
+	float* block = static_cast<float*>(resource->allocate(blockBytes(newStride), PIECE_ALIGNMENT));
+	std::memset(block, 0, blockBytes(newStride));
+
+	if (data)
+	{
+		for (int k = 0; k < PIECE_FLOAT_ARRAYS; k++)
+			std::memcpy(block + k * newStride, array(k), count * sizeof(float));
+		std::memcpy(block + PIECE_FLOAT_ARRAYS * newStride, rotations(), count);
+		resource->deallocate(data, blockBytes(stride), PIECE_ALIGNMENT);
+	}
+
+	data = block;
+	stride = newStride;
+}
+
+size_t pieceBlockBytes(size_t count)
+{
+	return blockBytes(paddedCount(count)) + PIECE_ALIGNMENT;
+}
+
+const glm::quat& rotationQuat(uint8_t rotation)
+{
+	return rotationTables.quats[rotation];
+}
+
+const glm::mat3& rotationMatrix(uint8_t rotation)
+{
+	return rotationTables.matrices[rotation];
+}
+
+uint8_t rotationIndex(glm::quat orientation)
+{
+	glm::mat3 m = glm::mat3_cast(glm::normalize(orientation));
+	for (int r = 0; r < CUBE_ROTATIONS; r++)
+	{
+		if (sameRotation(m, rotationTables.matrices[r])) return (uint8_t)r;
+	}
+	return 0;
+}
+
+uint8_t turnRotation(uint8_t rotation, int axis, bool positive)
+{
+	return rotationTables.turns[axis][positive][rotation];
+}
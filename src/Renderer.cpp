@@ -0,0 +1,553 @@
+#include <renderer.hpp>
+
+const float cubeVertices[] = {
+      // Pos                // Tex Coords
+        -0.5f, -0.5f, -0.5f,  0.25f, 0.5f, // Red - Back
+         0.5f, -0.5f, -0.5f,  0.5f, 0.5f,
+         0.5f,  0.5f, -0.5f,  0.5f, 1.0f,
+         0.5f,  0.5f, -0.5f,  0.5f, 1.0f,
+        -0.5f,  0.5f, -0.5f,  0.25f, 1.0f,
+        -0.5f, -0.5f, -0.5f,  0.25f, 0.5f,
+
+        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,  // Orange - Front
+         0.5f, -0.5f,  0.5f,  0.25f, 0.0f,
+         0.5f,  0.5f,  0.5f,  0.25f, 0.5f,
+         0.5f,  0.5f,  0.5f,  0.25f, 0.5f,
+        -0.5f,  0.5f,  0.5f,  0.0f, 0.5f,
+        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+        -0.5f,  0.5f,  0.5f,  0.25f, 0.0f, // Green - Left
+        -0.5f,  0.5f, -0.5f,  0.5f,  0.0f,               
+        -0.5f, -0.5f, -0.5f,  0.5f,  0.5f,               
+        -0.5f, -0.5f, -0.5f,  0.5f,  0.5f,               
+        -0.5f, -0.5f,  0.5f,  0.25f, 0.5f,              
+        -0.5f,  0.5f,  0.5f,  0.25f, 0.0f,              
+
+         0.5f,  0.5f,  0.5f,  0.5f,  0.5f,  // Blue - Right
+         0.5f,  0.5f, -0.5f,  0.75f, 0.5f,
+         0.5f, -0.5f, -0.5f,  0.75f, 1.0f,
+         0.5f, -0.5f, -0.5f,  0.75f, 1.0f,
+         0.5f, -0.5f,  0.5f,  0.5f,  1.0f,
+         0.5f,  0.5f,  0.5f,  0.5f,  0.5f,
+
+        -0.5f, -0.5f, -0.5f,  0.0f, 0.5f,  // White - Bottom 
+         0.5f, -0.5f, -0.5f,  0.25f, 0.5f,                
+         0.5f, -0.5f,  0.5f,  0.25f, 1.0f,                
+         0.5f, -0.5f,  0.5f,  0.25f, 1.0f,                
+        -0.5f, -0.5f,  0.5f,  0.0f, 1.0f,                 
+        -0.5f, -0.5f, -0.5f,  0.0f, 0.5f,                 
+
+        -0.5f,  0.5f, -0.5f,  0.75f, 0.5f, //Yellow - Top
+         0.5f,  0.5f, -0.5f,  1.0f, 0.5f,
+         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+        -0.5f,  0.5f,  0.5f,  0.75f, 1.0f,
+        -0.5f,  0.5f, -0.5f,  0.75f, 0.5f
+};
+
+// Colored faces of the vertex array above, in the order back, front, left, right, bottom, top
+#define CUBE_FACES 6
+#define FACE_VERTICES 6
+#define VERTEX_FLOATS 8
+
+// Where the hidden inner faces sample the black part of the texture
+const float hiddenTexCoords[FACE_VERTICES * 2] = {
+	0.5f, 0.0f,  0.75f, 0.0f,  0.75f, 0.5f,
+	0.75f, 0.5f,  0.5f, 0.5f,  0.5f, 0.0f
+};
+
+// Only the faces on the outside of the cube are colored, the rest are black
+static uint8_t faceMask(glm::vec3 home, float limit)
+{
+	return (home.z == -limit) << 0 | (home.z == limit) << 1
+		| (home.x == -limit) << 2 | (home.x == limit) << 3
+		| (home.y == -limit) << 4 | (home.y == limit) << 5;
+}
+
+// Points the per vertex attributes at the mesh buffer bound to GL_ARRAY_BUFFER
+static void meshAttributes()
+{
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(5 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+
+	glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(7 * sizeof(float)));
+	glEnableVertexAttribArray(3);
+}
+
+// Points the per piece attributes at a piece block uploaded as is to the buffer
+// bound to GL_ARRAY_BUFFER, each attribute reads one of its arrays
+static void pieceAttributes(const PieceTransforms& pieces)
+{
+	const char* block = static_cast<const char*>(pieces.block());
+	for (int axis = 0; axis < 3; axis++)
+	{
+		size_t offset = reinterpret_cast<const char*>(pieces.pos_array(axis)) - block;
+		glVertexAttribPointer(5 + axis, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)offset);
+		glEnableVertexAttribArray(5 + axis);
+	}
+
+	size_t rotationOffset = reinterpret_cast<const char*>(pieces.rotation_array()) - block;
+	glVertexAttribIPointer(8, 1, GL_UNSIGNED_BYTE, sizeof(uint8_t), (void*)rotationOffset);
+	glEnableVertexAttribArray(8);
+}
+
+// The 24 piece orientations never change, pieces only carry their index
+static void uploadRotations(unsigned int program)
+{
+	float rotations[CUBE_ROTATIONS * 9];
+	for (int r = 0; r < CUBE_ROTATIONS; r++)
+		std::memcpy(rotations + r * 9, glm::value_ptr(rotationMatrix(r)), 9 * sizeof(float));
+
+	glUseProgram(program);
+	glUniformMatrix3fv(glGetUniformLocation(program, "rotations"), CUBE_ROTATIONS, GL_FALSE, rotations);
+}
+
+Renderer::Renderer(StartupProfile& startup) : startup(startup)
+{
+	imageThread = std::thread(&Renderer::decode_texture, this);
+	build_mesh();
+
+	// Face quads are generated from gl_VertexID, the VAO only has to be bound
+	glGenVertexArrays(1, &lodVAO);
+}
+
+Renderer::~Renderer()
+{
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &maskVBO);
+	glDeleteBuffers(1, &instanceVBO);
+	glDeleteTextures(1, &texture);
+	glDeleteVertexArrays(1, &lodVAO);
+	glDeleteVertexArrays(1, &sceneVAO);
+	glDeleteBuffers(1, &sceneMaskVBO);
+	glDeleteBuffers(1, &scenePieceVBO);
+	glDeleteBuffers(1, &sceneCubeVBO);
+
+	imageThread.join();
+	stbi_image_free(image.data);
+}
+
+bool Renderer::draw(const CubeSnapshot& snapshot, const Camera& camera, float alpha)
+{
+	if (!is_ready() || snapshot.pieces.empty()) return false;
+
+	if (snapshot.cubeId != meshCubeId || snapshot.pieces.size() != instanceCount || snapshot.pieces.block_bytes() != instanceBytes)
+		build_instances(snapshot);
+
+	// Turning layers only cost a few uniforms, interpolated between the last two ticks
+	GLsizei sliceCount = (GLsizei)glm::min(snapshot.animations.size(), (size_t)MAX_PARALLEL_SLICES);
+	for (GLsizei a = 0; a < sliceCount; a++)
+	{
+		const SliceSnapshot& slice = snapshot.animations[a];
+		sliceLayers[a] = slice.faceIndex;
+		sliceAngles[a] = glm::radians(slice.previousRotationAngle + (slice.currentRotationAngle - slice.previousRotationAngle) * alpha);
+	}
+	int sliceAxis = rotationAxisIndex(snapshot.rotationDir);
+	float cubeScale = CUBE_WORLD_SIZE / snapshot.size;
+
+	// With textured faces, whole pieces are only needed around turning slices
+	bool lod = use_lod(snapshot.size, camera);
+	bool geometry = !lod || sliceCount > 0;
+
+	// Pieces are only uploaded when a turn has ended, never while one is animating
+	if (geometry && snapshot.stateVersion != instanceVersion)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, instanceBytes, snapshot.pieces.block());
+		instanceVersion = snapshot.stateVersion;
+	}
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	if (lod)
+	{
+		faces.update(snapshot);
+
+		glUseProgram(shaders.program(lodShader));
+		glUniformMatrix4fv(lodViewLoc, 1, GL_FALSE, glm::value_ptr(camera.get_view()));
+		glUniformMatrix4fv(lodProjectionLoc, 1, GL_FALSE, glm::value_ptr(camera.get_projection()));
+		glUniform1f(lodCubeScaleLoc, cubeScale);
+		glUniform1f(lodCubeSizeLoc, (float)snapshot.size);
+		glUniform1i(lodSliceAxisLoc, sliceAxis);
+		glUniform1i(lodSliceCountLoc, sliceCount);
+		if (sliceCount > 0)
+			glUniform1iv(lodSliceLayersLoc, sliceCount, sliceLayers);
+
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, faces.get_texture());
+		glActiveTexture(GL_TEXTURE0);
+
+		glBindVertexArray(lodVAO);
+		glDrawArrays(GL_TRIANGLES, 0, CUBE_FACES * FACE_VERTICES);
+	}
+
+	if (geometry)
+	{
+		glUseProgram(shaders.program(cubeShader));
+		glUniform1i(textureLoc, 0);
+		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(camera.get_view()));
+		glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(camera.get_projection()));
+		glUniform1f(cubeScaleLoc, cubeScale);
+		glUniform1f(layerOffsetLoc, (snapshot.size - 1) / 2.0f);
+		glUniform1i(sliceAxisLoc, sliceAxis);
+		glUniform1i(sliceCountLoc, sliceCount);
+		glUniform1i(lodCullLoc, lod);
+		if (sliceCount > 0)
+		{
+			glUniform1iv(sliceLayersLoc, sliceCount, sliceLayers);
+			glUniform1fv(sliceAnglesLoc, sliceCount, sliceAngles);
+		}
+
+		glBindVertexArray(VAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, CUBE_FACES * FACE_VERTICES, (GLsizei)instanceCount);
+	}
+	return true;
+}
+
+bool Renderer::draw_scene(const SceneSnapshot& scene, const Camera& camera, float alpha)
+{
+	if (!is_ready() || scene.cubes.empty()) return false;
+
+	// Only requested once a scene is shown, the single cube never waits for it
+	if (sceneShader < 0)
+		sceneShader = shaders.load(SCENE_VSHADER_PATH, FSHADER_PATH);
+	if (shaders.generation(sceneShader) != sceneGeneration)
+		bind_scene_shader();
+	if (!shaders.program(sceneShader)) return false;
+
+	if (scene.layoutId != sceneLayoutId || scene.pieces.block_bytes() != scenePieceBytes)
+		build_scene(scene);
+
+	// The pieces of every cube go up in one upload, and only after some turn ended
+	if (scene.stateVersion != sceneVersion)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, scenePieceVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, scenePieceBytes, scene.pieces.block());
+		sceneVersion = scene.stateVersion;
+	}
+
+	// Turning layers are the only per frame data, a few floats per cube
+	for (size_t c = 0; c < scene.cubes.size(); c++)
+	{
+		const CubeSnapshot& cube = scene.cubes[c];
+		SceneCubeInstance& instance = sceneCubes[c];
+
+		instance.cube.w = (float)rotationAxisIndex(cube.rotationDir);
+		std::fill(std::begin(instance.layerAngles), std::end(instance.layerAngles), 0.0f);
+		for (const SliceSnapshot& slice : cube.animations)
+			instance.layerAngles[slice.faceIndex] = glm::radians(slice.previousRotationAngle + (slice.currentRotationAngle - slice.previousRotationAngle) * alpha);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, sceneCubeVBO);
+	glBufferData(GL_ARRAY_BUFFER, sceneCubes.size() * sizeof(SceneCubeInstance), sceneCubes.data(), GL_STREAM_DRAW);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glUseProgram(shaders.program(sceneShader));
+	glUniformMatrix4fv(sceneViewLoc, 1, GL_FALSE, glm::value_ptr(camera.get_view()));
+	glUniformMatrix4fv(sceneProjectionLoc, 1, GL_FALSE, glm::value_ptr(camera.get_projection()));
+	glUniform1f(sceneCubeScaleLoc, sceneCubeScale);
+	glUniform1f(sceneLayerOffsetLoc, (scene.size - 1) / 2.0f);
+
+	glBindVertexArray(sceneVAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, CUBE_FACES * FACE_VERTICES, (GLsizei)(scene.cubes.size() * scene.piecesPerCube));
+	return true;
+}
+
+bool Renderer::is_ready()
+{
+	// Requested by the first draw rather than the constructor, so a cache miss
+	// compiles in the background and never holds back the first frame
+	if (cubeShader < 0)
+	{
+		shaderRequestTime = simulationClock();
+		cubeShader = shaders.load(VSHADER_PATH, FSHADER_PATH);
+		lodShader = shaders.load(LOD_VSHADER_PATH, LOD_FSHADER_PATH);
+	}
+	else
+	{
+		shaders.update();
+	}
+
+	if (!texture && imageReady)
+		upload_texture();
+
+	// A reloaded program has its own uniform locations and values
+	if (shaders.generation(cubeShader) != shaderGeneration)
+	{
+		if (shaderGeneration == 0)
+			startup.add("Cube shaders", (simulationClock() - shaderRequestTime) * 1000.0);
+		bind_shader();
+	}
+	if (shaders.generation(lodShader) != lodGeneration)
+		bind_lod_shader();
+
+	return shaders.program(cubeShader) && texture;
+}
+
+bool Renderer::use_lod(unsigned int size, const Camera& camera)
+{
+	if (!shaders.program(lodShader)) return false;
+
+	// Screen height of one sticker on the face nearest to the camera
+	float distance = glm::length(glm::vec3(camera.get_view()[3])) - CUBE_WORLD_SIZE / 2;
+	float pixels = CUBE_WORLD_SIZE / size * camera.get_projection()[1][1] * camera.get_viewport_height() / 2
+		/ glm::max(distance, CAMERA_NEAR);
+
+	// Leaving takes larger stickers than entering, so the mode does not flicker at the threshold
+	lodActive = pixels < (lodActive ? LOD_STICKER_PIXELS * LOD_HYSTERESIS : LOD_STICKER_PIXELS);
+	return lodActive;
+}
+
+void Renderer::bind_shader()
+{
+	unsigned int program = shaders.program(cubeShader);
+	shaderGeneration = shaders.generation(cubeShader);
+
+	viewLoc = glGetUniformLocation(program, "view");
+	projectionLoc = glGetUniformLocation(program, "projection");
+	textureLoc = glGetUniformLocation(program, "texture1");
+	cubeScaleLoc = glGetUniformLocation(program, "cubeScale");
+	layerOffsetLoc = glGetUniformLocation(program, "layerOffset");
+	sliceAxisLoc = glGetUniformLocation(program, "sliceAxis");
+	sliceCountLoc = glGetUniformLocation(program, "sliceCount");
+	sliceLayersLoc = glGetUniformLocation(program, "sliceLayers");
+	sliceAnglesLoc = glGetUniformLocation(program, "sliceAngles");
+	lodCullLoc = glGetUniformLocation(program, "lodCull");
+
+	uploadRotations(program);
+}
+
+void Renderer::bind_lod_shader()
+{
+	unsigned int program = shaders.program(lodShader);
+	lodGeneration = shaders.generation(lodShader);
+
+	lodViewLoc = glGetUniformLocation(program, "view");
+	lodProjectionLoc = glGetUniformLocation(program, "projection");
+	lodCubeScaleLoc = glGetUniformLocation(program, "cubeScale");
+	lodCubeSizeLoc = glGetUniformLocation(program, "cubeSize");
+	lodSliceAxisLoc = glGetUniformLocation(program, "sliceAxis");
+	lodSliceCountLoc = glGetUniformLocation(program, "sliceCount");
+	lodSliceLayersLoc = glGetUniformLocation(program, "sliceLayers");
+
+	// Where each color of the URFDLB order sits in the texture, read back from the
+	// colored faces of the piece mesh: top, right, front, bottom, left, back
+	const int meshFaces[CUBE_FACES] = { 5, 3, 1, 4, 2, 0 };
+	float origins[CUBE_FACES * 2];
+	glm::vec2 stickerSize(0.0f);
+	for (int color = 0; color < CUBE_FACES; color++)
+	{
+		glm::vec2 low(1.0f), high(0.0f);
+		for (int v = 0; v < FACE_VERTICES; v++)
+		{
+			const float* vertex = cubeVertices + (meshFaces[color] * FACE_VERTICES + v) * 5;
+			low = glm::min(low, glm::vec2(vertex[3], vertex[4]));
+			high = glm::max(high, glm::vec2(vertex[3], vertex[4]));
+		}
+		origins[color * 2] = low.x;
+		origins[color * 2 + 1] = low.y;
+		stickerSize = high - low;
+	}
+
+	glUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "texture1"), 0);
+	glUniform1i(glGetUniformLocation(program, "facelets"), 1);
+	glUniform2fv(glGetUniformLocation(program, "stickerOrigins"), CUBE_FACES, origins);
+	glUniform2fv(glGetUniformLocation(program, "stickerSize"), 1, glm::value_ptr(stickerSize));
+}
+
+void Renderer::bind_scene_shader()
+{
+	unsigned int program = shaders.program(sceneShader);
+	sceneGeneration = shaders.generation(sceneShader);
+
+	sceneViewLoc = glGetUniformLocation(program, "view");
+	sceneProjectionLoc = glGetUniformLocation(program, "projection");
+	sceneCubeScaleLoc = glGetUniformLocation(program, "cubeScale");
+	sceneLayerOffsetLoc = glGetUniformLocation(program, "layerOffset");
+
+	uploadRotations(program);
+	glUniform1i(glGetUniformLocation(program, "texture1"), 0);
+}
+
+void Renderer::build_mesh()
+{
+	// One unit cube shared by every piece. Each vertex also carries the black
+	// texture coordinates and its face, the shader picks per piece which to show.
+	float vertices[CUBE_FACES * FACE_VERTICES * VERTEX_FLOATS];
+	for (int face = 0; face < CUBE_FACES; face++)
+	{
+		for (int corner = 0; corner < FACE_VERTICES; corner++)
+		{
+			const float* source = cubeVertices + (face * FACE_VERTICES + corner) * 5;
+			float* vertex = vertices + (face * FACE_VERTICES + corner) * VERTEX_FLOATS;
+
+			for (int k = 0; k < 5; k++)
+				vertex[k] = source[k];
+			vertex[5] = hiddenTexCoords[corner * 2];
+			vertex[6] = hiddenTexCoords[corner * 2 + 1];
+			vertex[7] = (float)face;
+		}
+	}
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &maskVBO);
+	glGenBuffers(1, &instanceVBO);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	meshAttributes();
+
+	// Per piece: the mask of its colored faces, then its position and rotation index,
+	// pointed at once the piece arrays are uploaded
+	glBindBuffer(GL_ARRAY_BUFFER, maskVBO);
+	glVertexAttribIPointer(4, 1, GL_UNSIGNED_BYTE, sizeof(uint8_t), (void*)0);
+	glEnableVertexAttribArray(4);
+
+	for (int attribute = 4; attribute <= 8; attribute++)
+		glVertexAttribDivisor(attribute, 1);
+
+	// Scenes share the mesh and bring their own per piece and per cube buffers
+	glGenVertexArrays(1, &sceneVAO);
+	glGenBuffers(1, &sceneMaskVBO);
+	glGenBuffers(1, &scenePieceVBO);
+	glGenBuffers(1, &sceneCubeVBO);
+
+	glBindVertexArray(sceneVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	meshAttributes();
+
+	glBindBuffer(GL_ARRAY_BUFFER, sceneMaskVBO);
+	glVertexAttribIPointer(4, 1, GL_UNSIGNED_BYTE, sizeof(uint8_t), (void*)0);
+	glEnableVertexAttribArray(4);
+
+	glBindBuffer(GL_ARRAY_BUFFER, sceneCubeVBO);
+	glVertexAttribPointer(9, 4, GL_FLOAT, GL_FALSE, sizeof(SceneCubeInstance), (void*)offsetof(SceneCubeInstance, cube));
+	glEnableVertexAttribArray(9);
+	for (int half = 0; half < 2; half++)
+	{
+		size_t offset = offsetof(SceneCubeInstance, layerAngles) + half * 4 * sizeof(float);
+		glVertexAttribPointer(10 + half, 4, GL_FLOAT, GL_FALSE, sizeof(SceneCubeInstance), (void*)offset);
+		glEnableVertexAttribArray(10 + half);
+	}
+
+	for (int attribute = 4; attribute <= 8; attribute++)
+		glVertexAttribDivisor(attribute, 1);
+
+	glBindVertexArray(0);
+}
+
+void Renderer::build_instances(const CubeSnapshot& snapshot)
+{
+	const PieceTransforms& pieces = snapshot.pieces;
+	meshCubeId = snapshot.cubeId;
+	instanceCount = pieces.size();
+	instanceBytes = pieces.block_bytes();
+	instanceVersion = 0;
+
+	float limit = (snapshot.size - 1) / 2.0f;
+	std::vector<uint8_t> masks(instanceCount);
+	for (size_t i = 0; i < instanceCount; i++)
+		masks[i] = faceMask(pieces.get_home(i), limit);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, maskVBO);
+	glBufferData(GL_ARRAY_BUFFER, masks.size(), masks.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, instanceBytes, nullptr, GL_DYNAMIC_DRAW);
+	pieceAttributes(pieces);
+
+	glBindVertexArray(0);
+}
+
+void Renderer::build_scene(const SceneSnapshot& scene)
+{
+	const PieceTransforms& pieces = scene.pieces;
+	sceneLayoutId = scene.layoutId;
+	scenePieceBytes = pieces.block_bytes();
+	sceneVersion = 0;
+
+	// The cubes stand on a square wall facing the camera, SCENE_WORLD_SIZE wide
+	size_t count = scene.cubes.size();
+	size_t columns = (size_t)std::ceil(std::sqrt((double)count));
+	size_t rows = (count + columns - 1) / columns;
+	float pitch = SCENE_WORLD_SIZE / columns;
+	sceneCubeScale = pitch / SCENE_CUBE_SPACING / scene.size;
+
+	sceneCubes.assign(count, {});
+	for (size_t c = 0; c < count; c++)
+	{
+		float x = ((float)(c % columns) - (columns - 1) / 2.0f) * pitch;
+		float y = ((rows - 1) / 2.0f - (float)(c / columns)) * pitch;
+		sceneCubes[c].cube = glm::vec4(x, y, 0.0f, 0.0f);
+	}
+
+	float limit = (scene.size - 1) / 2.0f;
+	std::vector<uint8_t> masks(pieces.size());
+	for (size_t i = 0; i < pieces.size(); i++)
+		masks[i] = faceMask(pieces.get_home(i), limit);
+
+	glBindVertexArray(sceneVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, sceneMaskVBO);
+	glBufferData(GL_ARRAY_BUFFER, masks.size(), masks.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ARRAY_BUFFER, scenePieceVBO);
+	glBufferData(GL_ARRAY_BUFFER, scenePieceBytes, nullptr, GL_DYNAMIC_DRAW);
+	pieceAttributes(pieces);
+
+	// Per cube attributes advance once every cube worth of pieces
+	for (int attribute = 9; attribute <= 11; attribute++)
+		glVertexAttribDivisor(attribute, (GLuint)scene.piecesPerCube);
+
+	glBindVertexArray(0);
+}
+
+void Renderer::decode_texture()
+{
+	double start = simulationClock();
+
+	int channels;
+	stbi_set_flip_vertically_on_load_thread(true);
+	image.data = stbi_load(TEXT_PATH, &image.width, &image.height, &channels, 3);
+
+	image.decodeMs = (simulationClock() - start) * 1000.0;
+	imageReady = true;
+}
+
+void Renderer::upload_texture()
+{
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	if (image.data)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		startup.add("Texture decode", image.decodeMs);
+	}
+	else
+	{
+		std::cout << "Failed to load texture" << std::endl;
+	}
+	stbi_image_free(image.data);
+	image.data = nullptr;
+}
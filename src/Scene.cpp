@@ -0,0 +1,263 @@
+#include <scene.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+static unsigned int sceneThreads(unsigned int threads)
+{
+	if (threads > 0) return threads;
+
+	// The render thread keeps a core of its own
+	unsigned int cores = std::thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 1;
+}
+
+Scene::Scene(unsigned int threads)
+	: threadCount(sceneThreads(threads)), tickStart(threadCount), tickDone(threadCount)
+{
+	std::random_device rd;
+	for (unsigned int w = 0; w < threadCount; w++)
+		generators.emplace_back(rd());
+}
+
+Scene::~Scene()
+{
+	stop();
+}
+
+void Scene::start()
+{
+	if (running) return;
+
+	running = true;
+	stopping = false;
+	for (unsigned int w = 1; w < threadCount; w++)
+		workers.emplace_back(&Scene::work, this, w);
+	thread = std::thread(&Scene::run, this);
+}
+
+void Scene::stop()
+{
+	running = false;
+
+	// The coordinator lets the workers go before it returns
+	if (thread.joinable())
+		thread.join();
+
+	for (std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+}
+
+void Scene::run()
+{
+	double lastTime = simulationClock();
+
+	while (running)
+	{
+		bool changed = process_commands();
+
+		double currentTime = simulationClock();
+		int ticks = timestep.advance(currentTime - lastTime);
+		lastTime = currentTime;
+
+		if (changed || ticks > 0)
+			publish(ticks, currentTime - timestep.get_alpha() * timestep.get_dt());
+
+		double remaining = (1.0 - timestep.get_alpha()) * timestep.get_dt();
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+	}
+
+	stopping = true;
+	tickStart.arrive_and_wait();
+}
+
+void Scene::work(unsigned int worker)
+{
+	while (true)
+	{
+		tickStart.arrive_and_wait();
+		if (stopping) return;
+
+		update_cubes(worker);
+		tickDone.arrive_and_wait();
+	}
+}
+
+void Scene::update_cubes(unsigned int worker)
+{
+	// Each thread owns a contiguous share of the cubes and of the block of pieces
+	size_t first = cubes.size() * worker / threadCount;
+	size_t last = cubes.size() * (worker + 1) / threadCount;
+
+	std::mt19937& gen = generators[worker];
+	std::uniform_int_distribution<> faceIndexDist(0, cubeSize - 1);
+	std::uniform_int_distribution<> boolDist(0, 1);
+	std::uniform_int_distribution<> dirDist(0, 2);
+	const RotateDirection dirs[3] = { line, col, face };
+	float dt = timestep.get_dt();
+
+	bool changed = false;
+	for (size_t c = first; c < last; c++)
+	{
+		Cube& cube = *cubes[c];
+		for (int t = 0; t < pendingTicks; t++)
+		{
+			// A cube at rest starts its next turn at once, so none of them ever stops
+			if (!cube.is_rotating())
+			{
+				cube.rotate_face(faceIndexDist(gen), boolDist(gen) == 0, dirs[dirDist(gen)]);
+				cube.numberOfMoves++;
+			}
+			cube.update(dt);
+		}
+
+		CubeSnapshot& snapshot = target->cubes[c];
+		unsigned int version = snapshot.stateVersion;
+		cube.fill_snapshot(snapshot);
+
+		if (snapshot.stateVersion != version)
+		{
+			target->pieces.copy_pieces(c * target->piecesPerCube, snapshot.pieces);
+			changed = true;
+		}
+	}
+
+	if (changed)
+		copied.store(true, std::memory_order_relaxed);
+}
+
+bool Scene::process_commands()
+{
+	bool changed = false;
+	bool layout = false;
+	unsigned int cubeCount = 0, size = 0;
+	SceneCommand command;
+
+	while (commands.pop(command))
+	{
+		switch (command.type) {
+		case sceneLayoutCommand:
+			layout = true;
+			cubeCount = (unsigned int)command.value;
+			size = command.size;
+			break;
+		case sceneTickRateCommand:
+			timestep.set_tick_rate(command.value);
+			break;
+		case sceneTurnDurationCommand:
+			turnDuration = command.value / 1000.0f;
+			for (std::unique_ptr<Cube>& cube : cubes)
+				cube->set_turn_duration(turnDuration);
+			break;
+		}
+
+		changed = true;
+	}
+
+	// Dragging the cube count sends a layout every frame, only the last one is built
+	if (layout)
+		build_cubes(cubeCount, size);
+
+	return changed;
+}
+
+void Scene::build_cubes(unsigned int cubeCount, unsigned int size)
+{
+	cubes.clear();
+	cubes.reserve(cubeCount);
+	for (unsigned int c = 0; c < cubeCount; c++)
+	{
+		// Scene cubes are never solved, a history would only cost memory
+		cubes.push_back(std::make_unique<Cube>(size, false));
+		cubes.back()->set_turn_duration(turnDuration);
+	}
+
+	cubeSize = size;
+	layoutId++;
+}
+
+void Scene::publish(int ticks, double tickTime)
+{
+	SceneSnapshot& snapshot = snapshots.write_buffer();
+	double start = simulationClock();
+
+	// A new layout replaces every cube, none of the older copies can be reused
+	if (snapshot.layoutId != layoutId)
+	{
+		snapshot.layoutId = layoutId;
+		snapshot.size = cubeSize;
+		snapshot.piecesPerCube = cubePieceCount(cubeSize);
+		snapshot.cubes.clear();
+		snapshot.cubes.resize(cubes.size());
+		snapshot.pieces.resize(cubes.size() * snapshot.piecesPerCube);
+	}
+
+	target = &snapshot;
+	pendingTicks = ticks;
+	copied = false;
+
+	tickStart.arrive_and_wait();
+	update_cubes(0);
+	tickDone.arrive_and_wait();
+
+	if (copied)
+		snapshot.stateVersion = ++stateCounter;
+	snapshot.threads = threadCount;
+	snapshot.updateMs = (simulationClock() - start) * 1000.0;
+	snapshot.tickTime = tickTime;
+	snapshot.tickDt = timestep.get_dt();
+
+	snapshots.publish();
+}
+
+void Scene::send(SceneCommand command)
+{
+	if (!commands.push(command))
+		std::cerr << "Scene command queue full, command dropped" << std::endl;
+}
+
+void Scene::set_layout(unsigned int cubeCount, unsigned int size)
+{
+	cubeCount = std::min(cubeCount, (unsigned int)SCENE_MAX_CUBES);
+	size = std::clamp(size, (unsigned int)MIN_CUBE_SIZE, (unsigned int)SCENE_MAX_SIZE);
+	if (cubeCount == requestedCubes && size == requestedSize) return;
+
+	requestedCubes = cubeCount;
+	requestedSize = size;
+	send({ sceneLayoutCommand, (int)cubeCount, size });
+}
+
+void Scene::set_tick_rate(int tickRate)
+{
+	if (tickRate == requestedTickRate) return;
+
+	requestedTickRate = tickRate;
+	send({ sceneTickRateCommand, tickRate });
+}
+
+void Scene::set_turn_duration(float duration)
+{
+	int milliseconds = (int)(duration * 1000.0f + 0.5f);
+	if (milliseconds == requestedTurnDuration) return;
+
+	requestedTurnDuration = milliseconds;
+	send({ sceneTurnDurationCommand, milliseconds });
+}
+
+const SceneSnapshot& Scene::get_snapshot()
+{
+	return snapshots.read();
+}
+
+float Scene::get_alpha(const SceneSnapshot& snapshot)
+{
+	if (snapshot.tickDt <= 0.0f) return 1.0f;
+
+	float alpha = (float)((simulationClock() - snapshot.tickTime) / snapshot.tickDt);
+	if (alpha < 0.0f) alpha = 0.0f;
+	if (alpha > 1.0f) alpha = 1.0f;
+
+	return alpha;
+}
@@ -0,0 +1,299 @@
+#include <shader_manager.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static double nowSeconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool readFile(const std::string& path, std::string& code)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	code = stream.str();
+	return true;
+}
+
+static std::filesystem::file_time_type writeTime(const std::string& path)
+{
+	std::error_code error;
+	auto time = std::filesystem::last_write_time(path, error);
+	return error ? std::filesystem::file_time_type::min() : time;
+}
+
+// FNV-1a, only used to name cache files
+static uint64_t hashBytes(uint64_t hash, const std::string& bytes)
+{
+	for (unsigned char c : bytes)
+	{
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+ShaderManager::ShaderManager(const char* cacheDir) : cacheDir(cacheDir), lastPoll(nowSeconds())
+{
+	// Binaries are only valid for the driver that produced them
+	const char* vendor = (const char*)glGetString(GL_VENDOR);
+	const char* renderer = (const char*)glGetString(GL_RENDERER);
+	const char* version = (const char*)glGetString(GL_VERSION);
+	driver = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+
+	GLint formats = 0;
+	if (GLEW_ARB_get_program_binary)
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	binaryCache = formats > 0;
+
+	parallelCompile = GLEW_KHR_parallel_shader_compile;
+	if (parallelCompile)
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+
+	if (binaryCache)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(this->cacheDir, error);
+		if (error) binaryCache = false;
+	}
+}
+
+ShaderManager::~ShaderManager()
+{
+	for (ShaderProgram& shader : programs)
+	{
+		glDeleteProgram(shader.program);
+		glDeleteProgram(shader.pending);
+	}
+}
+
+int ShaderManager::load(const char* vertexPath, const char* fragmentPath)
+{
+	ShaderProgram shader;
+	shader.vertexPath = vertexPath;
+	shader.fragmentPath = fragmentPath;
+
+	std::string vertexCode, fragmentCode;
+	if (read_sources(shader, vertexCode, fragmentCode))
+	{
+		uint64_t key = source_key(vertexCode, fragmentCode);
+		if (unsigned int program = load_binary(key))
+		{
+			swap(shader, program);
+		}
+		else
+		{
+			shader.pending = start_build(vertexCode, fragmentCode);
+			shader.pendingKey = key;
+		}
+	}
+
+	programs.push_back(std::move(shader));
+	return (int)programs.size() - 1;
+}
+
+unsigned int ShaderManager::program(int handle) const
+{
+	return programs[handle].program;
+}
+
+unsigned int ShaderManager::generation(int handle) const
+{
+	return programs[handle].generation;
+}
+
+void ShaderManager::update()
+{
+	for (ShaderProgram& shader : programs)
+	{
+		if (!shader.pending || !is_built(shader.pending)) continue;
+
+		// A failed rebuild is dropped and the last working program stays in use
+		if (finish_build(shader.pending, shader.vertexPath.c_str()))
+		{
+			save_binary(shader.pending, shader.pendingKey);
+			swap(shader, shader.pending);
+		}
+		else
+		{
+			glDeleteProgram(shader.pending);
+		}
+		shader.pending = 0;
+	}
+
+	double now = nowSeconds();
+	if (now - lastPoll < SHADER_POLL_INTERVAL) return;
+	lastPoll = now;
+
+	for (ShaderProgram& shader : programs)
+	{
+		if (shader.pending) continue;
+		if (writeTime(shader.vertexPath) == shader.vertexTime && writeTime(shader.fragmentPath) == shader.fragmentTime) continue;
+
+		std::string vertexCode, fragmentCode;
+		if (!read_sources(shader, vertexCode, fragmentCode)) continue;
+
+		// Reverting to sources seen before is a cache hit, no compile at all
+		uint64_t key = source_key(vertexCode, fragmentCode);
+		if (unsigned int program = load_binary(key))
+		{
+			swap(shader, program);
+			continue;
+		}
+
+		shader.pending = start_build(vertexCode, fragmentCode);
+		shader.pendingKey = key;
+	}
+}
+
+uint64_t ShaderManager::source_key(const std::string& vertexCode, const std::string& fragmentCode) const
+{
+	uint64_t hash = 14695981039346656037ull;
+	hash = hashBytes(hash, vertexCode);
+	hash = hashBytes(hash, std::string(1, '\0'));
+	hash = hashBytes(hash, fragmentCode);
+	hash = hashBytes(hash, std::string(1, '\0'));
+	return hashBytes(hash, driver);
+}
+
+std::string ShaderManager::cache_path(uint64_t key) const
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return cacheDir + "/" + name;
+}
+
+unsigned int ShaderManager::load_binary(uint64_t key) const
+{
+	if (!binaryCache) return 0;
+
+	std::string bytes;
+	if (!readFile(cache_path(key), bytes) || bytes.size() <= sizeof(GLenum)) return 0;
+
+	GLenum format;
+	std::memcpy(&format, bytes.data(), sizeof(GLenum));
+
+	// The driver may still reject a binary it wrote, after an update for instance
+	unsigned int program = glCreateProgram();
+	glProgramBinary(program, format, bytes.data() + sizeof(GLenum), (GLsizei)(bytes.size() - sizeof(GLenum)));
+
+	GLint success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+void ShaderManager::save_binary(unsigned int program, uint64_t key) const
+{
+	if (!binaryCache) return;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+
+	std::vector<char> bytes(sizeof(GLenum) + length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, nullptr, &format, bytes.data() + sizeof(GLenum));
+	std::memcpy(bytes.data(), &format, sizeof(GLenum));
+
+	std::ofstream file(cache_path(key), std::ios::binary | std::ios::trunc);
+	if (!file.write(bytes.data(), bytes.size()))
+		std::cerr << "Could not write shader cache " << cache_path(key) << std::endl;
+}
+
+bool ShaderManager::read_sources(ShaderProgram& shader, std::string& vertexCode, std::string& fragmentCode)
+{
+	// Times are taken first, so an edit made while reading is seen at the next poll
+	shader.vertexTime = writeTime(shader.vertexPath);
+	shader.fragmentTime = writeTime(shader.fragmentPath);
+
+	if (!readFile(shader.vertexPath, vertexCode) || !readFile(shader.fragmentPath, fragmentCode))
+	{
+		std::cerr << "Could not read shader " << shader.vertexPath << " / " << shader.fragmentPath << std::endl;
+		return false;
+	}
+	return true;
+}
+
+unsigned int ShaderManager::start_build(const std::string& vertexCode, const std::string& fragmentCode) const
+{
+	const char* vertexSource = vertexCode.c_str();
+	const char* fragmentSource = fragmentCode.c_str();
+
+	unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertex, 1, &vertexSource, NULL);
+	glCompileShader(vertex);
+
+	unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragment, 1, &fragmentSource, NULL);
+	glCompileShader(fragment);
+
+	// Linked without waiting on the compiles, so a parallel driver overlaps them.
+	// The shaders are only flagged for deletion and live until the program goes.
+	unsigned int program = glCreateProgram();
+	glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	if (binaryCache)
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(program);
+
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+	return program;
+}
+
+bool ShaderManager::is_built(unsigned int program) const
+{
+	// Without the extension, querying the status waits for the build instead
+	if (!parallelCompile) return true;
+
+	GLint done = 0;
+	glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+	return done;
+}
+
+bool ShaderManager::finish_build(unsigned int program, const char* name) const
+{
+	GLint success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (success) return true;
+
+	char infoLog[1024];
+	unsigned int shaders[2];
+	GLsizei count = 0;
+	glGetAttachedShaders(program, 2, &count, shaders);
+	for (GLsizei i = 0; i < count; i++)
+	{
+		glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &success);
+		if (success) continue;
+
+		glGetShaderInfoLog(shaders[i], sizeof(infoLog), NULL, infoLog);
+		std::cerr << "Shader compilation failed (" << name << "):\n" << infoLog << std::endl;
+	}
+
+	glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+	std::cerr << "Shader linking failed (" << name << "):\n" << infoLog << std::endl;
+	return false;
+}
+
+void ShaderManager::swap(ShaderProgram& shader, unsigned int program)
+{
+	if (!program) return;
+
+	glDeleteProgram(shader.program);
+	shader.program = program;
+	shader.generation++;
+}
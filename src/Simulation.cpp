@@ -0,0 +1,239 @@
+#include <simulation.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+Simulation::Simulation(unsigned int size) : cube(new Cube(size))
+{
+	// The renderer may ask for a snapshot before the thread produced one
+	publish(simulationClock());
+}
+
+Simulation::~Simulation()
+{
+	stop();
+	delete cube;
+
+	SimCommand command;
+	while (commands.pop(command))
+		delete[] command.facelets;
+}
+
+void Simulation::start()
+{
+	if (running) return;
+
+	running = true;
+	thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop()
+{
+	running = false;
+	wake_up();
+
+	if (thread.joinable())
+		thread.join();
+}
+
+void Simulation::run()
+{
+	double lastTime = simulationClock();
+
+	while (running)
+	{
+		bool changed = process_commands();
+
+		double currentTime = simulationClock();
+		int ticks = timestep.advance(currentTime - lastTime);
+		lastTime = currentTime;
+
+		for (int i = 0; i < ticks; i++)
+			cube->update(timestep.get_dt());
+
+		if (changed || ticks > 0)
+			publish(currentTime - timestep.get_alpha() * timestep.get_dt());
+
+		// A resting cube has nothing to tick, only a command can change it
+		if (!cube->is_rotating())
+		{
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wake.wait(lock, [this] { return !running || !commands.empty(); });
+
+			// The time asleep is not caught up in ticks
+			lastTime = simulationClock();
+			continue;
+		}
+
+		// Sleep until the next tick is due, commands are picked up on wake
+		double remaining = (1.0 - timestep.get_alpha()) * timestep.get_dt();
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+	}
+}
+
+bool Simulation::process_commands()
+{
+	bool changed = false;
+	SimCommand command;
+
+	while (commands.pop(command))
+	{
+		switch (command.type) {
+		case moveCommand:
+			cube->rotate_face(command.params.faceIndex, command.params.contrary, command.params.dir, (unsigned int)command.value);
+			cube->numberOfMoves++;
+			break;
+		case scrambleCommand:
+			cube->scramble();
+			break;
+		case resetCommand:
+			delete cube;
+			cube = new Cube(command.value);
+			cube->set_turn_duration(turnDuration);
+			cubeId++;
+			break;
+		case tickRateCommand:
+			timestep.set_tick_rate(command.value);
+			break;
+		case loadCommand:
+			load_facelets(command);
+			break;
+		case solveCommand:
+			cube->solve();
+			break;
+		case finishCommand:
+			cube->finish();
+			break;
+		case turnDurationCommand:
+			turnDuration = command.value / 1000.0f;
+			cube->set_turn_duration(turnDuration);
+			break;
+		}
+
+		changed = true;
+	}
+
+	return changed;
+}
+
+void Simulation::load_facelets(SimCommand& command)
+{
+	Cube* loaded = new Cube(command.value);
+	loaded->set_turn_duration(turnDuration);
+
+	if (loaded->set_facelets(command.facelets))
+	{
+		delete cube;
+		cube = loaded;
+		cubeId++;
+	}
+	else
+	{
+		std::cerr << "Facelets do not describe a " << command.value << "x" << command.value << " cube, load ignored" << std::endl;
+		delete loaded;
+	}
+
+	delete[] command.facelets;
+}
+
+void Simulation::publish(double tickTime)
+{
+	CubeSnapshot& snapshot = snapshots.write_buffer();
+
+	cube->fill_snapshot(snapshot);
+	snapshot.cubeId = cubeId;
+	snapshot.tickTime = tickTime;
+	snapshot.tickDt = timestep.get_dt();
+
+	snapshots.publish();
+}
+
+void Simulation::send(SimCommand command)
+{
+	if (!commands.push(command))
+		std::cerr << "Simulation command queue full, command dropped" << std::endl;
+	wake_up();
+}
+
+void Simulation::wake_up()
+{
+	// Taking the lock orders the push before a wait that is about to start
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+	}
+	wake.notify_one();
+}
+
+void Simulation::rotate_face(int faceIndex, bool contrary, RotateDirection dir, unsigned int inputId)
+{
+	send({ moveCommand, { faceIndex, contrary, dir }, (int)inputId });
+}
+
+void Simulation::scramble()
+{
+	send({ scrambleCommand, {}, 0 });
+}
+
+void Simulation::reset(unsigned int size)
+{
+	send({ resetCommand, {}, (int)size });
+}
+
+void Simulation::load(unsigned int size, const uint8_t* facelets)
+{
+	size_t count = 6 * (size_t)size * size;
+	uint8_t* copy = new uint8_t[count];
+	std::copy(facelets, facelets + count, copy);
+
+	SimCommand command = { loadCommand, {}, (int)size, copy };
+	if (!commands.push(command))
+	{
+		std::cerr << "Simulation command queue full, command dropped" << std::endl;
+		delete[] copy;
+	}
+	wake_up();
+}
+
+void Simulation::solve()
+{
+	send({ solveCommand, {}, 0 });
+}
+
+void Simulation::finish()
+{
+	send({ finishCommand, {}, 0 });
+}
+
+void Simulation::set_turn_duration(float duration)
+{
+	int milliseconds = (int)(duration * 1000.0f + 0.5f);
+	if (milliseconds == requestedTurnDuration) return;
+
+	requestedTurnDuration = milliseconds;
+	send({ turnDurationCommand, {}, milliseconds });
+}
+
+void Simulation::set_tick_rate(int tickRate)
+{
+	if (tickRate == requestedTickRate) return;
+
+	requestedTickRate = tickRate;
+	send({ tickRateCommand, {}, tickRate });
+}
+
+const CubeSnapshot& Simulation::get_snapshot()
+{
+	return snapshots.read();
+}
+
+float Simulation::get_alpha(const CubeSnapshot& snapshot)
+{
+	if (snapshot.tickDt <= 0.0f) return 1.0f;
+
+	float alpha = (float)((simulationClock() - snapshot.tickTime) / snapshot.tickDt);
+	if (alpha < 0.0f) alpha = 0.0f;
+	if (alpha > 1.0f) alpha = 1.0f;
+
+	return alpha;
+}
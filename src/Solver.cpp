@@ -0,0 +1,214 @@
+#include <solver.hpp>
+#include <symmetry.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+int allowedFaces(int lastFace)
+{
+	// Never the same face twice, and of two opposite faces only the lower one first
+	int mask = 0x3F;
+	if (lastFace >= 0)
+	{
+		mask &= ~(1 << lastFace);
+		if (lastFace >= 3) mask &= ~(1 << (lastFace - 3));
+	}
+	return mask;
+}
+
+Solver::Solver(const PatternDatabase& corners, const PatternDatabase& edges) : corners(corners), edges(edges)
+{
+	// Pick the symmetry that carries the most untracked edges onto tracked ones
+	const PdbSpec& spec = edges.get_header().spec;
+	bool tracked[12] = {};
+	for (int i = 0; i < spec.edgeCount; i++)
+		tracked[spec.edges[i]] = true;
+
+	int best = -1;
+	for (int s = 0; s < SYMMETRY_COUNT; s++)
+	{
+		const CubieCube& symmetry = symmetryCube(s);
+		int score = 0;
+		for (int e = 0; e < 12; e++)
+			score += !tracked[e] && tracked[symmetry.ep[e]];
+
+		if (score > best)
+		{
+			best = score;
+			edgeSymmetry = s;
+		}
+	}
+}
+
+Solver::Bounds Solver::root_bounds(const Cube3& cube) const
+{
+	return { corners.lookup(cube), edges.lookup(cube), edges.lookup(conjugate(cube, edgeSymmetry)) };
+}
+
+int Solver::heuristic(const Cube3& cube) const
+{
+	Bounds bounds = root_bounds(cube);
+	return std::max(bounds.corners, std::max(bounds.edges, bounds.otherEdges));
+}
+
+bool Solver::child_bounds(const Cube3& cube, const Bounds& parent, int limit, Bounds& bounds) const
+{
+	// Cheapest table first, most children are cut before the edges are ranked
+	const PdbSpec& cornerPattern = corners.get_header().spec;
+	const PdbSpec& edgePattern = edges.get_header().spec;
+
+	bounds.corners = corners.distance(pdbIndex(cornerPattern, cube), parent.corners);
+	if (bounds.corners > limit) return false;
+
+	bounds.edges = edges.distance(pdbIndex(edgePattern, cube), parent.edges);
+	if (bounds.edges > limit) return false;
+
+	bounds.otherEdges = edges.distance(pdbIndex(edgePattern, conjugate(cube, edgeSymmetry)), parent.otherEdges);
+	return bounds.otherEdges <= limit;
+}
+
+bool Solver::search(const Cube3& cube, const Bounds& bounds, int depth, int bound, int lastFace, uint8_t* path, uint64_t& count)
+{
+	// Everything lives on the stack, the path is shared by the whole descent
+	if (cube.is_solved()) return depth == bound;
+	if (depth == bound || found.load(std::memory_order_relaxed)) return false;
+
+	int faces = allowedFaces(lastFace);
+	for (int face = 0; face < 6; face++)
+	{
+		if (!(faces & 1 << face)) continue;
+
+		for (int power = 0; power < 3; power++)
+		{
+			int move = face * 3 + power;
+			Cube3 child = cube;
+			child.apply(move);
+			count++;
+
+			Bounds childBounds;
+			if (!child_bounds(child, bounds, bound - depth - 1, childBounds)) continue;
+
+			path[depth] = (uint8_t)move;
+			if (search(child, childBounds, depth + 1, bound, face, path, count))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+int Solver::solve(const Cube3& cube, uint8_t* solution, int maxLength, unsigned int threads)
+{
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+	if (maxLength > SOLVER_MAX_DEPTH) maxLength = SOLVER_MAX_DEPTH;
+
+	nodes = 0;
+	found = false;
+	if (cube.is_solved()) return 0;
+
+	Bounds rootBounds = root_bounds(cube);
+	int start = std::max(rootBounds.corners, std::max(rootBounds.edges, rootBounds.otherEdges));
+
+	// Short solutions are searched from the root directly, and so is everything
+	// on a single thread, where building the frontier would not pay for itself
+	int serialLimit = threads == 1 ? maxLength : SOLVER_SPLIT_DEPTH;
+	for (int bound = start; bound <= maxLength && bound <= serialLimit; bound++)
+	{
+		uint64_t count = 0;
+		uint8_t path[SOLVER_MAX_DEPTH];
+		bool solved = search(cube, rootBounds, 0, bound, -1, path, count);
+		nodes += count;
+
+		if (solved)
+		{
+			memcpy(solution, path, bound);
+			return bound;
+		}
+	}
+
+	if (threads == 1) return -1;
+
+	// Every longer solution passes through one of these nodes. Nodes that are
+	// conjugates of each other are the same distance from solved, one is enough.
+	std::vector<Frontier> frontier = { { cube, rootBounds, {}, -1 } };
+	for (int depth = 0; depth < SOLVER_SPLIT_DEPTH; depth++)
+	{
+		std::vector<Frontier> next;
+		for (Frontier& node : frontier)
+		{
+			int faces = allowedFaces(node.lastFace);
+			for (int move = 0; move < CUBE3_MOVES; move++)
+			{
+				if (!(faces & 1 << (move / 3))) continue;
+
+				Frontier child = node;
+				child.cube.apply(move);
+				child.path[depth] = (uint8_t)move;
+				child.lastFace = move / 3;
+				child_bounds(child.cube, node.bounds, SOLVER_MAX_DEPTH, child.bounds);
+				next.push_back(child);
+			}
+		}
+		frontier.swap(next);
+	}
+
+	std::vector<std::pair<Cube3, int>> canonical;
+	for (int i = 0; i < (int)frontier.size(); i++)
+		canonical.push_back({ canonicalState(frontier[i].cube), i });
+
+	std::sort(canonical.begin(), canonical.end(), [](const auto& a, const auto& b) {
+		int order = memcmp(a.first.corners, b.first.corners, 8);
+		return order != 0 ? order < 0 : memcmp(a.first.edges, b.first.edges, 12) < 0;
+	});
+
+	std::vector<Frontier> unique;
+	for (size_t i = 0; i < canonical.size(); i++)
+	{
+		if (i == 0 || !(canonical[i].first == canonical[i - 1].first))
+			unique.push_back(frontier[canonical[i].second]);
+	}
+
+	for (int bound = std::max(start, SOLVER_SPLIT_DEPTH + 1); bound <= maxLength; bound++)
+	{
+		std::atomic<size_t> nextNode = 0;
+		int length = -1;
+
+		auto worker = [&]() {
+			uint64_t count = 0;
+			uint8_t path[SOLVER_MAX_DEPTH];
+
+			for (size_t i = nextNode++; i < unique.size() && !found; i = nextNode++)
+			{
+				const Frontier& node = unique[i];
+				const Bounds& b = node.bounds;
+				if (SOLVER_SPLIT_DEPTH + std::max(b.corners, std::max(b.edges, b.otherEdges)) > bound) continue;
+
+				memcpy(path, node.path, SOLVER_SPLIT_DEPTH);
+				if (search(node.cube, node.bounds, SOLVER_SPLIT_DEPTH, bound, node.lastFace, path, count))
+				{
+					bool expected = false;
+					if (found.compare_exchange_strong(expected, true))
+					{
+						memcpy(solution, path, bound);
+						length = bound;
+					}
+				}
+			}
+			nodes += count;
+		};
+
+		std::vector<std::thread> workers;
+		for (unsigned int i = 1; i < threads; i++)
+			workers.emplace_back(worker);
+		worker();
+		for (std::thread& thread : workers)
+			thread.join();
+
+		if (length >= 0) return length;
+	}
+
+	return -1;
+}
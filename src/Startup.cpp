@@ -0,0 +1,66 @@
+#include <startup.hpp>
+#include <timestep.hpp>
+
+#include <iostream>
+#include <iomanip>
+
+StartupProfile::StartupProfile() : startTime(simulationClock()), lastTime(startTime)
+{
+	phases.reserve(16);
+}
+
+void StartupProfile::mark(const char* name)
+{
+	double now = simulationClock();
+	phases.push_back({ name, (now - lastTime) * 1000.0, (now - startTime) * 1000.0, false });
+	lastTime = now;
+
+	// Steps after the first frame are printed as they land
+	if (has_first_frame()) print(phases.back());
+}
+
+void StartupProfile::add(const char* name, double durationMs)
+{
+	phases.push_back({ name, durationMs, (simulationClock() - startTime) * 1000.0, true });
+	if (has_first_frame()) print(phases.back());
+}
+
+void StartupProfile::first_frame()
+{
+	mark("First frame");
+	firstFrameMs = phases.back().end;
+
+	for (const StartupPhase& phase : phases)
+		print(phase);
+
+	if (firstFrameMs > STARTUP_TARGET_MS)
+		std::cerr << "Startup to first frame took " << firstFrameMs << " ms, over the " << STARTUP_TARGET_MS << " ms target" << std::endl;
+}
+
+bool StartupProfile::has_first_frame() const
+{
+	return firstFrameMs >= 0.0;
+}
+
+double StartupProfile::first_frame_ms() const
+{
+	return firstFrameMs;
+}
+
+const std::vector<StartupPhase>& StartupProfile::get_phases() const
+{
+	return phases;
+}
+
+void StartupProfile::print(const StartupPhase& phase) const
+{
+	std::ios::fmtflags flags = std::cout.flags();
+	std::streamsize precision = std::cout.precision();
+
+	std::cout << "Startup " << std::left << std::setw(16) << phase.name << std::right << std::fixed << std::setprecision(2)
+		<< std::setw(9) << phase.duration << " ms, done at " << std::setw(9) << phase.end << " ms"
+		<< (phase.background ? " (background)" : "") << std::endl;
+
+	std::cout.flags(flags);
+	std::cout.precision(precision);
+}
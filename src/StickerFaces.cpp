@@ -0,0 +1,118 @@
+#include <sticker_faces.hpp>
+#include <facelet_cube.hpp>
+
+#include <algorithm>
+
+static int stickerCoord(StickerPos p, int axis)
+{
+	return axis == 0 ? p.x : axis == 1 ? p.y : p.z;
+}
+
+bool StickerFaces::sync(const CubeSnapshot& snapshot)
+{
+	if (snapshot.cubeId == cubeId && snapshot.size == n && snapshot.stateVersion == version)
+		return false;
+
+	if (snapshot.cubeId != cubeId || snapshot.size != n || !replay(snapshot))
+		rebuild(snapshot);
+
+	cubeId = snapshot.cubeId;
+	version = snapshot.stateVersion;
+	return true;
+}
+
+void StickerFaces::turn(int axis, int layer, bool positive)
+{
+	// Sticker positions are doubled so the layer is an exact integer coordinate
+	int m = n - 1;
+	int target = 2 * layer - m;
+	moved.clear();
+
+	for (int face = 0; face < STICKER_FACES; face++)
+	{
+		int base = face * n * n;
+		int origin = stickerCoord(stickerPosition(n, base), axis);
+		int colStep = stickerCoord(stickerPosition(n, base + 1), axis) - origin;
+		int rowStep = stickerCoord(stickerPosition(n, base + n), axis) - origin;
+
+		if (colStep != 0)
+		{
+			// The layer crosses this face along one column
+			int col = (target - origin) / colStep;
+			for (unsigned int row = 0; row < n; row++)
+				moved.push_back(base + row * n + col);
+			dirtyCols[face * n + col] = 1;
+		}
+		else if (rowStep != 0)
+		{
+			int row = (target - origin) / rowStep;
+			for (unsigned int col = 0; col < n; col++)
+				moved.push_back(base + row * n + col);
+			dirtyRows[face * n + row] = 1;
+		}
+		else if (origin == target)
+		{
+			// An outer layer turns its whole face as well
+			for (unsigned int i = 0; i < n * n; i++)
+				moved.push_back(base + i);
+			dirtyFaces[face] = true;
+		}
+	}
+
+	movedColors.resize(moved.size());
+	for (size_t k = 0; k < moved.size(); k++)
+		movedColors[k] = facelets[moved[k]];
+
+	// A quarter turn back is three forward, the layer maps onto itself
+	int quarterTurns = positive ? 1 : 3;
+	for (size_t k = 0; k < moved.size(); k++)
+	{
+		StickerPos p = stickerPosition(n, moved[k]);
+		for (int q = 0; q < quarterTurns; q++)
+			p = rotateSticker(p, axis);
+		facelets[stickerIndex(n, p)] = movedColors[k];
+	}
+
+	dirty = true;
+}
+
+void StickerFaces::clear_dirty()
+{
+	std::fill(dirtyRows.begin(), dirtyRows.end(), 0);
+	std::fill(dirtyCols.begin(), dirtyCols.end(), 0);
+	for (int face = 0; face < STICKER_FACES; face++)
+		dirtyFaces[face] = false;
+	dirty = false;
+}
+
+void StickerFaces::rebuild(const CubeSnapshot& snapshot)
+{
+	n = snapshot.size;
+	facelets.resize(STICKER_FACES * n * n);
+	dirtyRows.assign(STICKER_FACES * n, 0);
+	dirtyCols.assign(STICKER_FACES * n, 0);
+	snapshotFacelets(snapshot, facelets.data());
+
+	for (int face = 0; face < STICKER_FACES; face++)
+		dirtyFaces[face] = true;
+	dirty = true;
+}
+
+bool StickerFaces::replay(const CubeSnapshot& snapshot)
+{
+	// The log must reach back to the state held here, without gaps
+	size_t first = 0;
+	while (first < snapshot.turns.size() && snapshot.turns[first].fromVersion != version)
+		first++;
+	if (first == snapshot.turns.size()) return false;
+
+	for (size_t k = first; k + 1 < snapshot.turns.size(); k++)
+	{
+		if (snapshot.turns[k].toVersion != snapshot.turns[k + 1].fromVersion) return false;
+	}
+	if (snapshot.turns.back().toVersion != snapshot.stateVersion) return false;
+
+	for (size_t k = first; k < snapshot.turns.size(); k++)
+		turn(snapshot.turns[k].axis, snapshot.turns[k].layer, snapshot.turns[k].positive);
+	return true;
+}
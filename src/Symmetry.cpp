@@ -0,0 +1,165 @@
+#include <symmetry.hpp>
+
+#include <cstring>
+
+static const CubieCube basicUrf3 = {
+	{ URF, DFR, DLF, UFL, UBR, DRB, DBL, ULB }, { 1, 2, 1, 2, 2, 1, 2, 1 },
+	{ UF, FR, DF, FL, UB, BR, DB, BL, UR, DR, DL, UL }, { 1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1 }
+};
+static const CubieCube basicF2 = {
+	{ DLF, DFR, DRB, DBL, UFL, URF, UBR, ULB }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ DL, DF, DR, DB, UL, UF, UR, UB, FL, FR, BR, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+};
+static const CubieCube basicU4 = {
+	{ UBR, URF, UFL, ULB, DRB, DFR, DLF, DBL }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ UB, UR, UF, UL, DB, DR, DF, DL, BR, FR, FL, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1 }
+};
+static const CubieCube basicLr2 = {
+	{ UFL, URF, UBR, ULB, DLF, DFR, DRB, DBL }, { 3, 3, 3, 3, 3, 3, 3, 3 },
+	{ UL, UF, UR, UB, DL, DF, DR, DB, FL, FR, BR, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+};
+
+// Twists add modulo 3, a mirrored corner (3..5) reverses the direction of what it is combined with
+static uint8_t combineTwist(int a, int b)
+{
+	if (a < 3 && b < 3) return (uint8_t)((a + b) % 3);
+	if (a < 3) return (uint8_t)(a + b >= 6 ? a + b - 3 : a + b);
+	if (b < 3) return (uint8_t)(a - b < 3 ? a - b + 3 : a - b);
+	return (uint8_t)(a - b < 0 ? a - b + 3 : a - b);
+}
+
+// a then b, in the same "replaced by" form as Cube3 moves
+static CubieCube multiply(const CubieCube& a, const CubieCube& b)
+{
+	CubieCube result;
+	for (int i = 0; i < 8; i++)
+	{
+		result.cp[i] = a.cp[b.cp[i]];
+		result.co[i] = combineTwist(a.co[b.cp[i]], b.co[i]);
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		result.ep[i] = a.ep[b.ep[i]];
+		result.eo[i] = (a.eo[b.ep[i]] + b.eo[i]) % 2;
+	}
+	return result;
+}
+
+struct SymmetryTables {
+	CubieCube cubes[SYMMETRY_COUNT];
+	int inverse[SYMMETRY_COUNT];
+	int moves[SYMMETRY_COUNT][CUBE3_MOVES];
+};
+
+static const SymmetryTables& symmetryTables()
+{
+	static const SymmetryTables* tables = [] {
+		SymmetryTables* t = new SymmetryTables;
+		CubieCube cube = toCubie(Cube3());
+
+		for (int urf3 = 0; urf3 < 3; urf3++)
+		{
+			for (int f2 = 0; f2 < 2; f2++)
+			{
+				for (int u4 = 0; u4 < 4; u4++)
+				{
+					for (int lr2 = 0; lr2 < 2; lr2++)
+					{
+						t->cubes[16 * urf3 + 8 * f2 + 2 * u4 + lr2] = cube;
+						cube = multiply(cube, basicLr2);
+					}
+					cube = multiply(cube, basicU4);
+				}
+				cube = multiply(cube, basicF2);
+			}
+			cube = multiply(cube, basicUrf3);
+		}
+
+		CubieCube identity = toCubie(Cube3());
+		for (int s = 0; s < SYMMETRY_COUNT; s++)
+		{
+			for (int r = 0; r < SYMMETRY_COUNT; r++)
+			{
+				CubieCube product = multiply(t->cubes[s], t->cubes[r]);
+				if (memcmp(&product, &identity, sizeof(CubieCube)) == 0)
+					t->inverse[s] = r;
+			}
+		}
+
+		for (int s = 0; s < SYMMETRY_COUNT; s++)
+		{
+			for (int move = 0; move < CUBE3_MOVES; move++)
+			{
+				Cube3 moved;
+				moved.apply(move);
+				Cube3 image = fromCubie(multiply(multiply(t->cubes[s], toCubie(moved)), t->cubes[t->inverse[s]]));
+
+				t->moves[s][move] = -1;
+				for (int candidate = 0; candidate < CUBE3_MOVES; candidate++)
+				{
+					Cube3 other;
+					other.apply(candidate);
+					if (other == image) t->moves[s][move] = candidate;
+				}
+			}
+		}
+
+		return t;
+	}();
+
+	return *tables;
+}
+
+const CubieCube& symmetryCube(int symmetry)
+{
+	return symmetryTables().cubes[symmetry];
+}
+
+int inverseSymmetry(int symmetry)
+{
+	return symmetryTables().inverse[symmetry];
+}
+
+int conjugateMove(int symmetry, int move)
+{
+	return symmetryTables().moves[symmetry][move];
+}
+
+Cube3 conjugate(const Cube3& cube, int symmetry)
+{
+	// Works on the packed bytes directly, this runs for every node of a search
+	const SymmetryTables& tables = symmetryTables();
+	const CubieCube& s = tables.cubes[symmetry];
+	const CubieCube& inverse = tables.cubes[tables.inverse[symmetry]];
+
+	Cube3 result;
+	for (int i = 0; i < 8; i++)
+	{
+		// (cube * S^-1) at slot i, then relabelled by S
+		int slot = inverse.cp[i];
+		int corner = cube.corner_perm(slot);
+		int twist = combineTwist(cube.corner_ori(slot), inverse.co[i]);
+		result.corners[i] = (uint8_t)(s.cp[corner] + 8 * combineTwist(s.co[corner], twist));
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		int slot = inverse.ep[i];
+		int edge = cube.edge_perm(slot);
+		int flip = cube.edge_ori(slot) ^ inverse.eo[i] ^ s.eo[edge];
+		result.edges[i] = (uint8_t)(s.ep[edge] | flip << 4);
+	}
+	return result;
+}
+
+Cube3 canonicalState(const Cube3& cube)
+{
+	Cube3 best = cube;
+	for (int symmetry = 1; symmetry < SYMMETRY_COUNT; symmetry++)
+	{
+		Cube3 candidate = conjugate(cube, symmetry);
+		if (memcmp(candidate.corners, best.corners, 8) < 0 ||
+			(memcmp(candidate.corners, best.corners, 8) == 0 && memcmp(candidate.edges, best.edges, 12) < 0))
+			best = candidate;
+	}
+	return best;
+}
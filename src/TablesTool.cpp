@@ -0,0 +1,196 @@
+#include <cube2.hpp>
+#include <pdb.hpp>
+#include <solver.hpp>
+#include <timestep.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+static void printUsage()
+{
+	std::cout << "Usage:" << std::endl;
+	std::cout << "  RubikTables cube2 [file] [threads]" << std::endl;
+	std::cout << "  RubikTables solve2 <file> <scramble>" << std::endl;
+	std::cout << "  RubikTables pdb <corners|edges1..edges7> <file> [mod3] [threads]" << std::endl;
+	std::cout << "  RubikTables lookup <file> <scramble>" << std::endl;
+	std::cout << "  RubikTables solve <corner file> <edge file> <scramble> [threads]" << std::endl;
+}
+
+static bool applyScramble(Cube3& cube, const char* scramble)
+{
+	std::string rejected;
+	if (cube.apply(scramble, &rejected))
+		return true;
+
+	std::cerr << "Not a move: " << rejected << std::endl;
+	return false;
+}
+
+static int cube2Command(int argc, char** argv)
+{
+	const char* path = argc > 2 ? argv[2] : CUBE2_TABLE_PATH;
+	unsigned int threads = argc > 3 ? (unsigned int)std::stoul(argv[3]) : 0;
+
+	Cube2Table table;
+	double start = simulationClock();
+	if (!table.generate(threads))
+	{
+		std::cerr << "Breadth-first search did not reach every state" << std::endl;
+		return 1;
+	}
+	double elapsed = simulationClock() - start;
+
+	const Cube2TableHeader& header = table.get_header();
+	std::cout << "Explored " << header.stateCount << " states in " << elapsed << " s, God's number is " << header.maxDepth << std::endl;
+	for (uint32_t depth = 0; depth <= header.maxDepth; depth++)
+		std::cout << std::right << std::setw(4) << depth << " : " << std::setw(8) << header.distribution[depth] << std::endl;
+
+	if (!table.save(path))
+		return 1;
+
+	std::cout << "Table written to " << path << std::endl;
+	return 0;
+}
+
+static int solve2Command(char** argv)
+{
+	Cube2Table table;
+	if (!table.load(argv[2]))
+		return 1;
+
+	Cube3 cube;
+	if (!applyScramble(cube, argv[3]))
+		return 1;
+
+	uint8_t solution[CUBE2_MAX_DEPTH];
+	double start = simulationClock();
+	int length = table.solve(cube, solution, CUBE2_MAX_DEPTH);
+	double elapsed = simulationClock() - start;
+
+	if (length < 0)
+	{
+		std::cerr << "No solution found" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Solution (" << length << " moves, " << elapsed * 1e6 << " us) :";
+	for (int i = 0; i < length; i++)
+		std::cout << " " << moveName(solution[i]);
+	std::cout << std::endl;
+
+	return 0;
+}
+
+static int pdbCommand(int argc, char** argv)
+{
+	std::string name = argv[2];
+	PdbSpec spec;
+	if (name == "corners")
+		spec = cornerSpec();
+	else if (name.size() == 6 && name.compare(0, 5, "edges") == 0 && name[5] >= '1' && name[5] <= '0' + PDB_MAX_EDGES)
+		spec = edgeSpec(name[5] - '0');
+	else
+	{
+		printUsage();
+		return 1;
+	}
+
+	PdbFormat format = argc > 4 && std::string(argv[4]) == "mod3" ? mod3Format : nibbleFormat;
+	unsigned int threads = argc > 5 ? (unsigned int)std::stoul(argv[5]) : 0;
+
+	PatternDatabase pdb;
+	double start = simulationClock();
+	if (!pdb.generate(spec, threads))
+	{
+		std::cerr << "Breadth-first search did not reach every state" << std::endl;
+		return 1;
+	}
+	double elapsed = simulationClock() - start;
+
+	const PdbHeader& header = pdb.get_header();
+	std::cout << "Explored " << header.stateCount << " " << name << " states in " << elapsed << " s, max depth " << header.maxDepth << std::endl;
+	for (uint32_t depth = 0; depth <= header.maxDepth; depth++)
+		std::cout << std::right << std::setw(4) << depth << " : " << std::setw(10) << header.distribution[depth] << std::endl;
+
+	if (!pdb.save(argv[3], format))
+		return 1;
+
+	std::cout << "Table written to " << argv[3] << (format == mod3Format ? " (2 bits per state)" : " (4 bits per state)") << std::endl;
+	return 0;
+}
+
+static int lookupCommand(char** argv)
+{
+	PatternDatabase pdb;
+	double start = simulationClock();
+	if (!pdb.load(argv[2]))
+		return 1;
+	double loaded = simulationClock();
+
+	Cube3 cube;
+	if (!applyScramble(cube, argv[3]))
+		return 1;
+	int distance = pdb.lookup(cube);
+	double elapsed = simulationClock() - loaded;
+
+	std::cout << "Pattern distance " << distance << " (mapped in " << (loaded - start) * 1e3 << " ms, looked up in "
+		<< elapsed * 1e6 << " us)" << std::endl;
+	return 0;
+}
+
+static int solveCommand(int argc, char** argv)
+{
+	PatternDatabase corners, edges;
+	if (!corners.load(argv[2]) || !edges.load(argv[3]))
+		return 1;
+
+	if (corners.get_header().spec.kind != cornerPdb || edges.get_header().spec.kind != edgePdb)
+	{
+		std::cerr << "Expected a corner table followed by an edge table" << std::endl;
+		return 1;
+	}
+
+	Cube3 cube;
+	if (!applyScramble(cube, argv[4]))
+		return 1;
+	unsigned int threads = argc > 5 ? (unsigned int)std::stoul(argv[5]) : 0;
+
+	Solver solver(corners, edges);
+	uint8_t solution[SOLVER_MAX_DEPTH];
+	double start = simulationClock();
+	int length = solver.solve(cube, solution, SOLVER_MAX_DEPTH, threads);
+	double elapsed = simulationClock() - start;
+
+	if (length < 0)
+	{
+		std::cerr << "No solution found" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Optimal solution (" << length << " moves, " << solver.get_nodes() << " nodes, " << elapsed << " s) :";
+	for (int i = 0; i < length; i++)
+		std::cout << " " << moveName(solution[i]);
+	std::cout << std::endl;
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	std::string command = argc > 1 ? argv[1] : "";
+
+	if (command == "cube2")
+		return cube2Command(argc, argv);
+	if (command == "solve2" && argc >= 4)
+		return solve2Command(argv);
+	if (command == "pdb" && argc >= 4)
+		return pdbCommand(argc, argv);
+	if (command == "lookup" && argc >= 4)
+		return lookupCommand(argv);
+	if (command == "solve" && argc >= 5)
+		return solveCommand(argc, argv);
+
+	printUsage();
+	return 1;
+}
@@ -0,0 +1,56 @@
+#include <timestep.hpp>
+
+#include <chrono>
+
+FixedTimestep::FixedTimestep(int tickRate) : tickRate(tickRate), dt(1.0 / tickRate) {}
+
+int FixedTimestep::advance(double frameTime)
+{
+	// A long hitch (window drag, breakpoint) must not queue up hundreds of ticks
+	if (frameTime > MAX_FRAME_TIME) frameTime = MAX_FRAME_TIME;
+	if (frameTime < 0.0) frameTime = 0.0;
+
+	accumulator += frameTime;
+
+	int ticks = 0;
+	while (accumulator >= dt)
+	{
+		accumulator -= dt;
+		ticks++;
+	}
+
+	return ticks;
+}
+
+void FixedTimestep::set_tick_rate(int newTickRate)
+{
+	if (newTickRate == tickRate) return;
+	if (newTickRate < MIN_TICK_RATE) newTickRate = MIN_TICK_RATE;
+	if (newTickRate > MAX_TICK_RATE) newTickRate = MAX_TICK_RATE;
+
+	// Keep the same fraction of a tick pending so alpha does not jump
+	accumulator = accumulator / dt * (1.0 / newTickRate);
+	tickRate = newTickRate;
+	dt = 1.0 / tickRate;
+}
+
+float FixedTimestep::get_dt()
+{
+	return (float)dt;
+}
+
+float FixedTimestep::get_alpha()
+{
+	return (float)(accumulator / dt);
+}
+
+int FixedTimestep::get_tick_rate()
+{
+	return tickRate;
+}
+
+double simulationClock()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
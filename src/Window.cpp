@@ -1,7 +1,15 @@
 #include <window.hpp>
+#include <cube_io.hpp>
+#include <cubie.hpp>
+
+#include <fstream>
+#include <vector>
 
 Window::Window(int width, int height, const std::string& name)
-    : width(width), height(height), name(name), window(nullptr), io(nullptr), deltaTime(0.0f), lastFrame(0.0f), cube(nullptr) {}
+    : deltaTime(0.0f), width(width), height(height), name(name), window(nullptr), io(nullptr), camera(width, height), lastFrame(0.0f), simulation(nullptr), startup(nullptr)
+{
+    viewOrientation = keymap.view_orientation(settings.rotationAngle, settings.flipAngle);
+}
 
 Window::~Window()
 {
@@ -9,15 +17,20 @@ Window::~Window()
     glfwTerminate();
 }
 
-bool Window::init()
+bool Window::init(StartupProfile& startup)
 {
+    this->startup = &startup;
+
     if (!init_GLFW())
         return false;
-    
+    startup.mark("GLFW window");
+
     if (!init_GLEW())
         return false;
+    startup.mark("GLEW");
 
     init_imGui();
+    startup.mark("ImGui");
 
     return true;
 }
@@ -56,11 +69,16 @@ bool Window::init_GLFW()
 
     glfwMakeContextCurrent(window);
 
-    glViewport(0, 0, W_WIDTH, W_HEIGHT);
+    // The framebuffer can differ from the requested window size on high DPI screens
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    resize(framebufferWidth, framebufferHeight);
+
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetWindowUserPointer(window, this);
     glfwSetWindowPos(window, 100, 100);
     glfwSetKeyCallback(window, keyCallback);
+    glfwSwapInterval(vsync ? 1 : 0);
 
     glEnable(GL_DEPTH_TEST);
 
@@ -82,14 +100,26 @@ void Window::clear()
     GLfloat currentFrame = glfwGetTime();
     deltaTime = currentFrame - lastFrame;
     lastFrame = currentFrame;
+}
 
-    update_view_rotation();
+void Window::tick(GLfloat dt)
+{
+    previousRotationAngle = settings.rotationAngle;
+    previousFlipAngle = settings.flipAngle;
+
+    update_view_rotation(dt);
 }
 
-void Window::update()
+void Window::update(const CubeSnapshot& snapshot)
 {
+    latency.frame_rendered(snapshot);
     glfwSwapBuffers(window);
-    glfwPollEvents();
+    latency.frame_presented(vsync);
+
+    if (viewRotating || !snapshot.animations.empty() || snapshot.queuedMoves > 0)
+        pacer.keep_awake();
+
+    pacer.end_frame(settings);
 }
 
 void Window::init_imGui()
@@ -124,20 +154,22 @@ void Window::cleanup_imGui()
     ImGui::DestroyContext();
 }
 
-void Window::draw_ui_frames(Cube*& _cube)
+void Window::draw_ui_frames(Simulation& _simulation, const CubeSnapshot& snapshot, const SceneSnapshot& scene)
 {
-    cube = _cube;
+    simulation = &_simulation;
 
     new_imGui_frame();
 
-    draw_main_frame(_cube);
+    draw_main_frame(snapshot, scene);
     draw_controls_frame();
-    draw_cube_infos_frame(_cube);
+    draw_cube_infos_frame(snapshot);
+    if (settings.measureLatency)
+        draw_latency_frame();
 
     render_imGui();
 }
   
-void Window::draw_main_frame(Cube*& _cube)
+void Window::draw_main_frame(const CubeSnapshot& snapshot, const SceneSnapshot& scene)
 {
     ImGuiWindowFlags window_flags = 0;
     window_flags |= ImGuiWindowFlags_NoResize;
@@ -151,27 +183,62 @@ void Window::draw_main_frame(Cube*& _cube)
     ImGui::RadioButton("2x2", &settings.tempCubeSize, 2); ImGui::SameLine();
     ImGui::RadioButton("3x3", &settings.tempCubeSize, 3); ImGui::SameLine();
     ImGui::RadioButton("4x4", &settings.tempCubeSize, 4);
+    ImGui::SliderInt("Any Size", &settings.tempCubeSize, MIN_CUBE_SIZE, MAX_CUBE_SIZE);
     if (ImGui::Button("Reset"))
     {
-        delete _cube;
-        _cube = new Cube(settings.tempCubeSize);
+        simulation->reset(settings.tempCubeSize);
         settings.cubeSize = settings.tempCubeSize;
-
-        cube = _cube;
     }
     ImGui::SameLine();
     if (ImGui::Button("Scramble"))
     {
-        cube->scramble();
+        simulation->scramble();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Solve"))
+    {
+        // Solving replays the recorded moves backwards, a loaded state has none
+        if (!snapshot.historyComplete)
+            stateStatus = "No move history to undo, Solve only works on cubes turned from solved";
+        else if (snapshot.historyMoves == 0 && snapshot.queuedMoves == 0)
+            stateStatus = "Nothing to undo";
+        else
+            simulation->solve();
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Skip to End"))
+    {
+        simulation->finish();
+    }
+    ImGui::SliderFloat("Turn Duration", &settings.turnDuration, MIN_TURN_DURATION, MAX_TURN_DURATION, "%.2f s");
 
     ImGui::NewLine();
     ImGui::SeparatorText("CAMERA");
     ImGui::SliderFloat("Camera Distance", &settings.zoom, 2.0f, 10.0f);
 
+    ImGui::NewLine();
+    ImGui::SeparatorText("SIMULATION");
+    ImGui::SliderInt("Tick Rate", &settings.tickRate, MIN_TICK_RATE, MAX_TICK_RATE);
+
+    ImGui::NewLine();
+    ImGui::SeparatorText("SCENE");
+    ImGui::Checkbox("Many Cubes", &settings.showScene);
+    ImGui::SliderInt("Cubes", &settings.sceneCubes, 1, SCENE_MAX_CUBES);
+    if (settings.showScene)
+        ImGui::Text("%zu cubes of %ux%u, %.2f ms/tick on %u threads",
+            scene.cubes.size(), scene.size, scene.size, scene.updateMs, scene.threads);
+
     ImGui::NewLine();
     ImGui::SeparatorText("GRAPHICS");
     ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / io->Framerate, io->Framerate);
+
+    const PacerStats& pacing = pacer.get_stats();
+    ImGui::Text("%s: %.1f frames/s, %.0f%% frame work, %.0f%% waiting (%.0f%% idle)",
+        pacer.is_idle(settings) ? "Idle" : "Active", pacing.framesPerSecond, pacing.workPercent, pacing.waitPercent, pacing.idlePercent);
+    ImGui::Checkbox("Only Redraw on Change", &settings.idleThrottle);
+    if (settings.idleThrottle)
+        ImGui::SliderFloat("Idle Redraw Every", &settings.idleWait, MIN_IDLE_WAIT, MAX_IDLE_WAIT, "%.1f s");
+    ImGui::SliderInt("Frame Cap", &settings.frameCap, 0, MAX_FRAME_CAP, settings.frameCap > 0 ? "%d FPS" : "Off");
     ImGui::Checkbox("Show Polygons", &settings.showPolygons);
     if (settings.showPolygons)
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -184,6 +251,19 @@ void Window::draw_main_frame(Cube*& _cube)
     else
         glDisable(GL_MULTISAMPLE);
 
+    ImGui::Checkbox("VSync", &settings.vsync);
+    if (settings.vsync != vsync)
+    {
+        vsync = settings.vsync;
+        glfwSwapInterval(vsync ? 1 : 0);
+    }
+
+    ImGui::Checkbox("Measure Latency", &settings.measureLatency);
+    latency.enabled = settings.measureLatency;
+
+    if (startup->has_first_frame() && ImGui::CollapsingHeader("Startup"))
+        draw_startup_table();
+
     ImGui::End();
 }
 
@@ -222,155 +302,37 @@ void Window::draw_controls_frame()
         ImGui::EndTable();
     }
 
-    ImGui::NewLine();
-    ImGui::SeparatorText("LINES");
-
-    if (ImGui::BeginTable("Controls", 2, flags))
-    {
-        ImGui::TableSetupColumn("one", ImGuiTableColumnFlags_WidthFixed, 120.0f);
-
-        ImGui::TableNextRow();
-        ImGui::TableSetColumnIndex(0);
-        ImGui::Text("U");
-
-        ImGui::TableSetColumnIndex(1);
-        ImGui::Text("Up");
-
-        if (settings.cubeSize == 4)
-        {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("I");
-
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("Inner Up (u)");
-        }
-
-        if (settings.cubeSize == 3)
-        {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("E");
-
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("Equator");
-        }
-
-        ImGui::TableNextRow();
-        ImGui::TableSetColumnIndex(0);
-        ImGui::Text("D");
-
-        ImGui::TableSetColumnIndex(1);
-        ImGui::Text("Down");
-
-        if (settings.cubeSize == 4)
-        {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("S");
-
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("Inner Down (d)");
-        }
-
-        ImGui::EndTable();
-    }
-
-    ImGui::NewLine();
-    ImGui::SeparatorText("COLUMNS");
-
-    if (ImGui::BeginTable("Controls", 2, flags))
-    {
-        ImGui::TableSetupColumn("one", ImGuiTableColumnFlags_WidthFixed, 120.0f);
-
-        ImGui::TableNextRow();
-        ImGui::TableSetColumnIndex(0);
-        ImGui::Text("L");
-
-        ImGui::TableSetColumnIndex(1);
-        ImGui::Text("Left");
-
-        if (settings.cubeSize == 4)
-        {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("K");
-
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("Inner Left (l)");
-        }
-
-        if (settings.cubeSize == 3)
-        {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("M");
-
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("Middle");
-        }
-
-        ImGui::TableNextRow();
-        ImGui::TableSetColumnIndex(0);
-        ImGui::Text("R");
-
-        ImGui::TableSetColumnIndex(1);
-        ImGui::Text("Right");
-
-        if (settings.cubeSize == 4)
-        {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("T");
-
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("Inner Right (r)");
-        }
-
-        ImGui::EndTable();
-    }
+    const char* groupNames[3] = { "LINES", "COLUMNS", "FACES" };
+    const KeyBinding* bindings = keymap.get_bindings();
 
-    ImGui::NewLine();
-    ImGui::SeparatorText("FACES");
-    if (ImGui::BeginTable("Controls", 2, flags))
+    for (int group = linesGroup; group <= facesGroup; group++)
     {
-        ImGui::TableSetupColumn("one", ImGuiTableColumnFlags_WidthFixed, 120.0f);
-
-        ImGui::TableNextRow();
-        ImGui::TableSetColumnIndex(0);
-        ImGui::Text("F");
+        ImGui::NewLine();
+        ImGui::SeparatorText(groupNames[group]);
 
-        ImGui::TableSetColumnIndex(1);
-        ImGui::Text("Front");
-
-        if (settings.cubeSize == 4)
+        if (ImGui::BeginTable("Controls", 2, flags))
         {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("C");
+            ImGui::TableSetupColumn("one", ImGuiTableColumnFlags_WidthFixed, 120.0f);
 
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("Inner Front (f)");
-        }
+            for (int i = 0; i < keymap.get_binding_count(); i++)
+            {
+                const KeyBinding& binding = bindings[i];
+                if (binding.group != group || !keymap.is_available(binding, settings.cubeSize))
+                    continue;
 
-        ImGui::TableNextRow();
-        ImGui::TableSetColumnIndex(0);
-        ImGui::Text("B");
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", binding.keyName);
 
-        ImGui::TableSetColumnIndex(1);
-        ImGui::Text("Back");
-
-        if (settings.cubeSize == 4)
-        {
-            ImGui::TableNextRow();
-            ImGui::TableSetColumnIndex(0);
-            ImGui::Text("V");
+                ImGui::TableSetColumnIndex(1);
+                if (binding.depth == 1)
+                    ImGui::Text("%s (%s)", binding.name, binding.notation);
+                else
+                    ImGui::Text("%s", binding.name);
+            }
 
-            ImGui::TableSetColumnIndex(1);
-            ImGui::Text("Inner Back (b)");
+            ImGui::EndTable();
         }
-
-        ImGui::EndTable();
     }
 
     ImGui::NewLine();
@@ -413,7 +375,7 @@ void Window::draw_controls_frame()
     ImGui::End();
 }
 
-void Window::draw_cube_infos_frame(Cube*& _cube)
+void Window::draw_cube_infos_frame(const CubeSnapshot& snapshot)
 {
     ImGuiWindowFlags window_flags = 0;
     window_flags |= ImGuiWindowFlags_NoResize;
@@ -422,432 +384,210 @@ void Window::draw_cube_infos_frame(Cube*& _cube)
     ImGui::Begin("Cube Infos", NULL, window_flags);
 
     ImGui::Text("Last move : %s", lastMove.c_str());
-    ImGui::Text("Number of Moves : %u", cube->numberOfMoves);
+    ImGui::Text("Number of Moves : %u", snapshot.numberOfMoves);
+    ImGui::Text("Queued Moves : %u", snapshot.queuedMoves);
+    if (snapshot.historyComplete)
+        ImGui::Text("Moves to Undo : %u", snapshot.historyMoves);
+    else
+        ImGui::Text("Moves to Undo : unknown");
+
+    if (ImGui::Button("Save State"))
+        save_state(snapshot);
+    ImGui::SameLine();
+    if (ImGui::Button("Load State"))
+        load_state();
+    if (!stateStatus.empty())
+        ImGui::Text("%s", stateStatus.c_str());
     
     ImGui::End();
 }
 
-SETTINGS Window::get_settings()
-{
-    return settings;
-}
-
-void Window::processInput(int key, int scancode, int action, int mods)
+void Window::save_state(const CubeSnapshot& snapshot)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    std::vector<uint8_t> facelets(faceletStringLength(snapshot.size));
+    std::string text(facelets.size(), ' ');
+    snapshotFacelets(snapshot, facelets.data());
+    writeFaceletString(facelets, text);
 
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
-        shiftDown = true;
-    else if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_RELEASE)
-        shiftDown = false;
-
-    
-
-    if (!viewRotating && action == GLFW_PRESS)
+    std::ofstream file(CUBE_STATE_PATH);
+    if (!file)
     {
-        RotateDirection dir;
-        int faceIndex = 0;
-        // rotIndex value : 0 = orange face front, 1 = blue face front, ... 
-        int rotIndex = abs((int)(round(settings.rotationAngle) / 90) % 4);
-
-        if ((int)round(settings.rotationAngle) % 180 == 40 || (int)round(settings.rotationAngle) % 180 == -140)
-            dir = col;
-        else
-            dir = face;
-
-        if (key == GLFW_KEY_L)
-        {
-            lastMove = "Left";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
-
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-            {
-                if (rotIndex == 1 || rotIndex == 2)
-                    faceIndex = 2;
-                if (rotIndex == 2 || rotIndex == 3)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    shiftDown = !shiftDown;
-            }
-            else
-            {
-                if (rotIndex == 3 || rotIndex == 2)
-                    faceIndex = 2;
-                if (settings.rotationAngle < 0)
-                    faceIndex == 0 ? faceIndex = 2 : faceIndex = 0;
-                if (rotIndex == 1 || rotIndex == 2)
-                    shiftDown = !shiftDown;
-            }
-
-            if (settings.cubeSize == 2 && faceIndex != 0) faceIndex = 1;
-            if (settings.cubeSize == 4 && faceIndex != 0) faceIndex = 3;
-
-            cube->rotate_face(faceIndex, !shiftDown, dir);
-            cube->numberOfMoves++;
-            
-        }
-
-        if (key == GLFW_KEY_K && settings.cubeSize == 4)
-        {
-            lastMove = "Inner Left";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
-
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-            {
-                if (rotIndex == 1 || rotIndex == 2)
-                    faceIndex = 2;
-                if (rotIndex == 2 || rotIndex == 3)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    shiftDown = !shiftDown;
-            }
-            else
-            {
-                if (rotIndex == 3 || rotIndex == 2)
-                    faceIndex = 2;
-                if (settings.rotationAngle < 0)
-                    faceIndex == 0 ? faceIndex = 2 : faceIndex = 0;
-                if (rotIndex == 1 || rotIndex == 2)
-                    shiftDown = !shiftDown;
-            }
-
-            if (faceIndex == 0) faceIndex++;
-
-            cube->rotate_face(faceIndex, !shiftDown, dir);
-            cube->numberOfMoves++;
-        }
-
-        if (key == GLFW_KEY_M && settings.cubeSize == 3)
-        {
-            if (settings.cubeSize != 2)
-            {
-                lastMove = "Middle";
-                if (shiftDown)
-                    lastMove = "Inverse " + lastMove;
-
-                faceIndex = 1;
-
-                if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-                {
-                    if (rotIndex == 2 || rotIndex == 3)
-                        shiftDown = !shiftDown;
-                    if (settings.rotationAngle < 0)
-                        shiftDown = !shiftDown;
-                }
-                else
-                {
-                    if (rotIndex == 1 || rotIndex == 2)
-                        shiftDown = !shiftDown;
-                }
-
-                cube->rotate_face(faceIndex, !shiftDown, dir);
-                cube->numberOfMoves++;
-            }
-        }
-
-        if (key == GLFW_KEY_R)
-        {
-            lastMove = "Right";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
-
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-            {
-                if (rotIndex == 0 || rotIndex == 3)
-                    faceIndex = 2;
-                if (rotIndex == 2 || rotIndex == 3)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    shiftDown = !shiftDown;
-            }
-            else
-            {
-                if (rotIndex == 3 || rotIndex == 2)
-                    faceIndex = 2;
-                if (settings.rotationAngle > 0)
-                    faceIndex == 0 ? faceIndex = 2 : faceIndex = 0;
-                if (rotIndex == 1 || rotIndex == 2)
-                    shiftDown = !shiftDown;
-            }
-
-            if (settings.cubeSize == 2 && faceIndex == 2) faceIndex = 1;
-            if (settings.cubeSize == 4 && faceIndex == 2) faceIndex = 3;
+        stateStatus = "Failed to open " CUBE_STATE_PATH;
+        return;
+    }
 
-            cube->rotate_face(faceIndex, shiftDown, dir);
-            cube->numberOfMoves++;
-        }
+    file << text << '\n';
+    stateStatus = "Saved to " CUBE_STATE_PATH;
+}
 
-        if (key == GLFW_KEY_T && settings.cubeSize == 4)
-        {
-            lastMove = "Inner Right";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
+void Window::load_state()
+{
+    std::ifstream file(CUBE_STATE_PATH);
+    std::string text;
+    if (!file || !(file >> text))
+    {
+        stateStatus = "Failed to read " CUBE_STATE_PATH;
+        return;
+    }
 
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-            {
-                if (rotIndex == 1 || rotIndex == 2)
-                    faceIndex = 2;
-                if (rotIndex == 2 || rotIndex == 3)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    shiftDown = !shiftDown;
-            }
-            else
-            {
-                if (rotIndex == 3 || rotIndex == 2)
-                    faceIndex = 2;
-                if (settings.rotationAngle < 0)
-                    faceIndex == 0 ? faceIndex = 2 : faceIndex = 0;
-                if (rotIndex == 1 || rotIndex == 2)
-                    shiftDown = !shiftDown;
-            }
+    unsigned int size = faceletStringSize(text);
+    if (size > MAX_CUBE_SIZE)
+    {
+        stateStatus = "Cube larger than the size limit";
+        return;
+    }
 
-            if (faceIndex == 2) faceIndex--;
-            if (faceIndex == 0) faceIndex += 2;
+    std::vector<uint8_t> facelets(faceletStringLength(size));
+    if (size < 2 || !readFaceletString(text, facelets))
+    {
+        stateStatus = "Not a URFDLB facelet string";
+        return;
+    }
 
-            cube->rotate_face(faceIndex, !shiftDown, dir);
-            cube->numberOfMoves++;
-        }
+    // A 3x3 with its centers home can be checked for twist, flip and parity
+    bool centersHome = size == 3;
+    for (int face = 0; face < 6 && centersHome; face++)
+        centersHome = facelets[face * 9 + 4] == face;
 
-        if (key == GLFW_KEY_U)
+    if (centersHome)
+    {
+        CubieCube cubie;
+        CubeError error = faceletsToCubie(facelets.data(), cubie);
+        if (error == cubeValid) error = validate(cubie);
+        if (error != cubeValid)
         {
-            lastMove = "Up";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
-
-            dir = line;
-
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-                faceIndex = 2;
-            else
-                shiftDown = !shiftDown;
-
-            if (settings.cubeSize == 2 && faceIndex != 0) faceIndex = 1;
-            if (settings.cubeSize == 4 && faceIndex != 0) faceIndex = 3;
-
-            cube->rotate_face(faceIndex, shiftDown, dir);
-            cube->numberOfMoves++;
+            stateStatus = std::string("Invalid cube: ") + cubeErrorName(error);
+            return;
         }
+    }
 
-        if (key == GLFW_KEY_I && settings.cubeSize == 4)
-        {
-            lastMove = "Inner Up";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
-
-            dir = line;
-
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-                faceIndex = 2;
-            else
-                shiftDown = !shiftDown;
-
-            if (settings.cubeSize == 4)
-            {
-                if (faceIndex == 0) faceIndex = 1;
-                else faceIndex = 2;
-            }
-
-            cube->rotate_face(faceIndex, shiftDown, dir);
-            cube->numberOfMoves++;
-        }
+    simulation->load(size, facelets.data());
+    settings.cubeSize = size;
+    settings.tempCubeSize = size;
+    lastMove = "";
+    stateStatus = "Loaded " + std::to_string(size) + "x" + std::to_string(size) + " from " CUBE_STATE_PATH;
+}
 
-        if (key == GLFW_KEY_E && settings.cubeSize == 3)
-        {
-            if (settings.cubeSize != 2)
-            {
-                lastMove = "Equator";
-                if (shiftDown)
-                    lastMove = "Inverse " + lastMove;
+void Window::draw_latency_frame()
+{
+    ImGuiWindowFlags window_flags = 0;
+    window_flags |= ImGuiWindowFlags_NoCollapse;
 
-                dir = line;
+    ImGui::Begin("Latency", NULL, window_flags);
 
-                faceIndex = 1;
+    ImGui::Text("Key press to first moving frame / to buffer swap (%s)", vsync ? "vsync on" : "vsync off");
 
-                if ((int)round(settings.flipAngle) / 180 % 2 != 0)
-                    shiftDown = !shiftDown;
+    const char* labels[2] = { "Key to frame", "Key to swap" };
+    for (int i = 0; i < 2; i++)
+    {
+        bool toSwap = i == 1;
+        LatencyStats stats = latency.get_stats(toSwap);
 
-                cube->rotate_face(faceIndex, !shiftDown, dir);
-                cube->numberOfMoves++;
-            }
-        }
+        float buckets[LATENCY_BUCKETS];
+        latency.get_histogram(buckets, toSwap);
 
-        if (key == GLFW_KEY_D)
-        {
-            lastMove = "Down";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
+        ImGui::SeparatorText(labels[i]);
+        ImGui::Text("n=%u  mean %.1f ms  p50 %.1f ms  p95 %.1f ms  max %.1f ms",
+            stats.count, stats.mean, stats.p50, stats.p95, stats.max);
+        ImGui::PlotHistogram(labels[i], buckets, LATENCY_BUCKETS, 0, NULL, 0.0f, FLT_MAX, ImVec2(0, 60));
+    }
+    ImGui::Text("Buckets of %.0f ms, last one holds everything above", LATENCY_BUCKET_MS);
 
-            dir = line;
+    if (ImGui::Button("Export CSV"))
+        latency.export_csv(LATENCY_CSV_PATH);
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+        latency.clear();
 
-            if ((int)round(settings.flipAngle) / 180 % 2 != 0)
-            {
-                faceIndex = 2;
-                shiftDown = !shiftDown;
-            }
+    ImGui::End();
+}
 
-            if (settings.cubeSize == 2 && faceIndex == 2) faceIndex = 1;
-            if (settings.cubeSize == 4 && faceIndex != 0) faceIndex = 3;
+void Window::draw_startup_table()
+{
+    ImGui::Text("First frame after %.1f ms (target %.0f ms)", startup->first_frame_ms(), STARTUP_TARGET_MS);
 
-            cube->rotate_face(faceIndex, !shiftDown, dir);
-            cube->numberOfMoves++;
-        }
+    ImGuiTableFlags flags = ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter;
+    if (ImGui::BeginTable("Startup", 3, flags))
+    {
+        ImGui::TableSetupColumn("Step");
+        ImGui::TableSetupColumn("Took");
+        ImGui::TableSetupColumn("Done at");
+        ImGui::TableHeadersRow();
 
-        if (key == GLFW_KEY_S && settings.cubeSize == 4)
+        for (const StartupPhase& phase : startup->get_phases())
         {
-            lastMove = "Inner Down";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
-
-            dir = line;
-
-            if ((int)round(settings.flipAngle) / 180 % 2 != 0)
-            {
-                faceIndex = 2;
-                shiftDown = !shiftDown;
-            }
-
-            if (settings.cubeSize == 4)
-            {
-                if (faceIndex != 2) faceIndex = 1;
-            }
-
-            cube->rotate_face(faceIndex, !shiftDown, dir);
-            cube->numberOfMoves++;
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s%s", phase.name.c_str(), phase.background ? " *" : "");
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.2f ms", phase.duration);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f ms", phase.end);
         }
+        ImGui::EndTable();
+    }
+    ImGui::Text("* lazy or on a worker thread, overlapping later steps");
+}
 
-        if ((int)round(settings.rotationAngle) % 180 == 40 || (int)round(settings.rotationAngle) % 180 == -140)
-            dir = face;
-        else
-            dir = col;
-
-        if (key == GLFW_KEY_B)
-        {
-            lastMove = "Back";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
-
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-            {
-                if (rotIndex == 2 || rotIndex == 3)
-                    faceIndex = 2;
-                if (rotIndex == 2 || rotIndex == 1)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    faceIndex == 0 ? faceIndex = 2 : faceIndex = 0;
-            }
-            else
-            {
-                if (rotIndex == 0 || rotIndex == 3)
-                    faceIndex = 2;
-                if (rotIndex == 0 || rotIndex == 1)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    shiftDown = !shiftDown;
-            }
+SETTINGS Window::get_settings()
+{
+    return settings;
+}
 
-            if (settings.cubeSize == 2 && faceIndex == 2) faceIndex = 1;
-            if (settings.cubeSize == 4 && faceIndex == 2) faceIndex = 3;
+SETTINGS Window::get_render_settings(float alpha)
+{
+    SETTINGS renderSettings = settings;
 
-            cube->rotate_face(faceIndex, shiftDown, dir);
-            cube->numberOfMoves++;
-        }
+    if (viewRotating)
+    {
+        renderSettings.rotationAngle = previousRotationAngle + (settings.rotationAngle - previousRotationAngle) * alpha;
+        renderSettings.flipAngle = previousFlipAngle + (settings.flipAngle - previousFlipAngle) * alpha;
+    }
 
-        if (key == GLFW_KEY_V && settings.cubeSize == 4)
-        {
-            lastMove = "Inner Back";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
+    return renderSettings;
+}
 
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-            {
-                if (rotIndex == 2 || rotIndex == 3)
-                    faceIndex = 2;
-                if (rotIndex == 2 || rotIndex == 1)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    faceIndex == 0 ? faceIndex = 2 : faceIndex = 0;
-            }
-            else
-            {
-                if (rotIndex == 0 || rotIndex == 3)
-                    faceIndex = 2;
-                if (rotIndex == 0 || rotIndex == 1)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    shiftDown = !shiftDown;
-            }
+const Camera& Window::get_camera(float alpha)
+{
+    camera.update(get_render_settings(alpha));
+    return camera;
+}
 
-            if (faceIndex == 0) faceIndex = 1;
+void Window::keep_awake()
+{
+    pacer.keep_awake();
+}
 
-            cube->rotate_face(faceIndex, shiftDown, dir);
-            cube->numberOfMoves++;
-        }
+void Window::resize(int width, int height)
+{
+    glViewport(0, 0, width, height);
+    camera.set_viewport(width, height);
+}
 
-        if (key == GLFW_KEY_F)
-        {
-            lastMove = "Front";
-            if (shiftDown)
-                lastMove = "Inverse " + lastMove;
+void Window::processInput(int key, int scancode, int action, int mods)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
 
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-            {
-                if (rotIndex == 1 || rotIndex == 0)
-                    faceIndex = 2;
-                if (rotIndex == 2 || rotIndex == 1)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    faceIndex == 0 ? faceIndex = 2 : faceIndex = 0;
-            }
-            else
-            {
-                if (rotIndex == 1 || rotIndex == 2)
-                    faceIndex = 2;
-                if (rotIndex == 0 || rotIndex == 1)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    shiftDown = !shiftDown;
-            }
+    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+        shiftDown = true;
+    else if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_RELEASE)
+        shiftDown = false;
 
-            if (settings.cubeSize == 2 && faceIndex == 2) faceIndex = 1;
-            if (settings.cubeSize == 4 && faceIndex == 2) faceIndex = 3;
+    
 
-            cube->rotate_face(faceIndex, !shiftDown, dir);
-            cube->numberOfMoves++;
-        }
+    if (!viewRotating && action == GLFW_PRESS)
+    {
+        const KeyBinding* binding = keymap.find(key);
+        RotationParams params;
 
-        if (key == GLFW_KEY_C && settings.cubeSize == 4)
+        if (binding && keymap.to_move(*binding, viewOrientation, settings.cubeSize, shiftDown, params))
         {
-            lastMove = "Inner Front";
+            lastMove = binding->name;
             if (shiftDown)
                 lastMove = "Inverse " + lastMove;
 
-            if ((int)round(settings.flipAngle) / 180 % 2 == 0)
-            {
-                if (rotIndex == 1 || rotIndex == 0)
-                    faceIndex = 2;
-                if (rotIndex == 2 || rotIndex == 1)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    faceIndex == 0 ? faceIndex = 2 : faceIndex = 0;
-            }
-            else
-            {
-                if (rotIndex == 1 || rotIndex == 2)
-                    faceIndex = 2;
-                if (rotIndex == 0 || rotIndex == 1)
-                    shiftDown = !shiftDown;
-                if (settings.rotationAngle < 0)
-                    shiftDown = !shiftDown;
-            }
-
-            if (faceIndex == 0) faceIndex = 1;
-
-            cube->rotate_face(faceIndex, !shiftDown, dir);
-            cube->numberOfMoves++;
+            simulation->rotate_face(params.faceIndex, params.contrary, params.dir, latency.key_pressed(keyEventTime));
         }
     }
 
@@ -874,6 +614,7 @@ void Window::keyCallback(GLFWwindow* window, int key, int scancode, int action,
 {
     Window* win = static_cast<Window*>(glfwGetWindowUserPointer(window));
     if (win) {
+        win->keyEventTime = simulationClock();
         win->processInput(key, scancode, action, mods);
     }
 }
@@ -899,11 +640,11 @@ void Window::start_view_rotation(std::string direction)
     }
 }
 
-void Window::update_view_rotation()
+void Window::update_view_rotation(GLfloat dt)
 {
     if (!viewRotating) return;
 
-    float angleStep = viewRotationSpeed * deltaTime;
+    float angleStep = viewRotationSpeed * dt;
     currentViewRotationAngle += angleStep;
 
     // stop condition
@@ -923,9 +664,16 @@ void Window::update_view_rotation()
         settings.rotationAngle += angleStep;
     if (viewRotDirection == "Right")
         settings.rotationAngle += angleStep;
+
+    if (!viewRotating)
+        viewOrientation = keymap.view_orientation(settings.rotationAngle, settings.flipAngle);
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    Window* instance = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    if (instance)
+        instance->resize(width, height);
+    else
+        glViewport(0, 0, width, height);
 }
\ No newline at end of file